@@ -18,6 +18,10 @@ class InferenceProjectConan(ConanFile):
         self.requires("onnxruntime/1.18.1")
         # 使用 fmt 库进行格式化输出
         self.requires("fmt/10.1.1")
+        # 使用 xxHash 计算结果缓存的内容哈希
+        self.requires("xxhash/0.8.2")
+        # 使用 nlohmann_json 解析 COCO 标注文件
+        self.requires("nlohmann_json/3.11.3")
 
     def configure(self):
         """配置选项"""
@@ -0,0 +1,179 @@
+#include "adaptive_controller.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+AdaptiveController::AdaptiveController(const ControllerConfig& config, DetectorFactory& factory)
+    : config_(config) {
+    if (config_.levels.empty()) {
+        std::cerr << "错误: 自适应控制器至少需要一个分辨率档位" << std::endl;
+        return;
+    }
+
+    ready_ = true;
+    for (const auto& level : config_.levels) {
+        std::unique_ptr<YOLOv5Detector> detector = factory.create(level.model_path,
+                                                                  level.confidence_threshold,
+                                                                  config_.nms_threshold);
+        if (!detector->is_model_loaded()) {
+            ready_ = false;
+        } else if (detector->has_dynamic_input()) {
+            if (!detector->set_input_size(level.input_size, level.input_size)) {
+                std::cerr << "错误: 档位输入尺寸 " << level.input_size << " 无效（需为 32 的倍数）" << std::endl;
+                ready_ = false;
+            }
+        } else if (detector->get_input_size().width != level.input_size) {
+            std::cerr << "警告: 模型 " << level.model_path << " 为固定尺寸 "
+                      << detector->get_input_size().width << "，忽略配置的输入尺寸 "
+                      << level.input_size << std::endl;
+        }
+        detector->set_max_candidates(level.max_candidates);
+        detectors_.push_back(std::move(detector));
+    }
+
+    level_latencies_.resize(config_.levels.size());
+    stats_.frames_per_level.assign(config_.levels.size(), 0);
+    stats_.p99_latency_ms.assign(config_.levels.size(), 0.0);
+}
+
+std::vector<Detection> AdaptiveController::detect(int stream_id, const cv::Mat& image, size_t queue_depth) {
+    if (!ready_) {
+        std::cerr << "错误: 自适应控制器未就绪" << std::endl;
+        return {};
+    }
+
+    int level = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        level = streams_[stream_id].level;
+    }
+
+    // 检测在锁外执行，不同流可以并发
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<Detection> detections = detectors_[level]->detect(image);
+    auto end = std::chrono::high_resolution_clock::now();
+    double latency_ms = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    StreamState& state = streams_[stream_id];
+
+    stats_.frames_per_level[level]++;
+    auto& level_window = level_latencies_[level];
+    level_window.push_back(latency_ms);
+    if (level_window.size() > config_.window_size) level_window.pop_front();
+
+    // 并发期间档位可能已被切换，只统计与当前档位一致的样本
+    if (state.level == level) {
+        update_level_locked(stream_id, state, latency_ms, queue_depth);
+    }
+
+    return detections;
+}
+
+void AdaptiveController::update_level_locked(int stream_id, StreamState& state, double latency_ms,
+                                             size_t queue_depth) {
+    state.latencies.push_back(latency_ms);
+    if (state.latencies.size() > config_.window_size) state.latencies.pop_front();
+    state.frames_since_switch++;
+
+    int num_levels = static_cast<int>(config_.levels.size());
+    double p99 = percentile(state.latencies, 0.99);
+
+    // 队列积压：不等待延迟窗口，但两次降级之间仍需间隔若干帧，让上一次降级有机会消化积压
+    if (queue_depth > config_.max_queue_depth && state.level + 1 < num_levels &&
+        state.frames_since_switch >= config_.min_frames_between_queue_switches) {
+        stats_.queue_downgrades++;
+        switch_level_locked(stream_id, state, state.level + 1, p99, queue_depth, "队列积压");
+        return;
+    }
+
+    if (state.latencies.size() < config_.min_window_samples ||
+        state.frames_since_switch < config_.min_frames_between_switches) {
+        return;
+    }
+
+    // p99 超出目标：降级
+    if (p99 > config_.latency_target_ms && state.level + 1 < num_levels) {
+        switch_level_locked(stream_id, state, state.level + 1, p99, queue_depth, "p99 超出目标");
+        return;
+    }
+
+    // 队列空闲且按像素数折算的上一档位 p99 仍留有余量：升级（upgrade_ratio < 1 提供滞回）
+    if (state.level > 0 && queue_depth == 0) {
+        cv::Size current = get_level_input_size(state.level);
+        cv::Size higher = get_level_input_size(state.level - 1);
+        double area_ratio = current.area() > 0 ? double(higher.area()) / current.area() : 1.0;
+        double predicted_p99 = p99 * std::max(1.0, area_ratio);
+        if (predicted_p99 < config_.latency_target_ms * config_.upgrade_ratio) {
+            switch_level_locked(stream_id, state, state.level - 1, p99, queue_depth, "延迟余量充足");
+        }
+    }
+}
+
+void AdaptiveController::switch_level_locked(int stream_id, StreamState& state, int new_level,
+                                             double p99_ms, size_t queue_depth, const char* reason) {
+    int old_level = state.level;
+
+    if (new_level > old_level) {
+        stats_.downgrades++;
+    } else {
+        stats_.upgrades++;
+    }
+
+    std::ostringstream message;
+    message << "[自适应] 流 " << stream_id << ": 档位 " << old_level << " ("
+            << get_level_input_size(old_level).width << ") -> " << new_level << " ("
+            << get_level_input_size(new_level).width << "), 原因: " << reason
+            << ", p99=" << std::fixed << std::setprecision(2) << p99_ms << " ms"
+            << ", 队列深度=" << queue_depth;
+    std::cout << message.str() << std::endl;
+
+    state.level = new_level;
+    state.latencies.clear();
+    state.frames_since_switch = 0;
+}
+
+bool AdaptiveController::is_ready() const {
+    return ready_;
+}
+
+int AdaptiveController::get_stream_level(int stream_id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = streams_.find(stream_id);
+    return it == streams_.end() ? 0 : it->second.level;
+}
+
+size_t AdaptiveController::get_num_levels() const {
+    return detectors_.size();
+}
+
+cv::Size AdaptiveController::get_level_input_size(int level) const {
+    if (level < 0 || level >= static_cast<int>(detectors_.size())) {
+        return cv::Size();
+    }
+    return detectors_[level]->get_input_size();
+}
+
+ControllerStats AdaptiveController::get_stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ControllerStats stats = stats_;
+    for (size_t i = 0; i < level_latencies_.size(); ++i) {
+        stats.p99_latency_ms[i] = percentile(level_latencies_[i], 0.99);
+    }
+    for (const auto& kv : streams_) {
+        stats.stream_levels[kv.first] = kv.second.level;
+    }
+    return stats;
+}
+
+double AdaptiveController::percentile(const std::deque<double>& samples, double q) {
+    if (samples.empty()) {
+        return 0.0;
+    }
+    std::vector<double> sorted(samples.begin(), samples.end());
+    size_t index = std::min(sorted.size() - 1, static_cast<size_t>(sorted.size() * q));
+    std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+    return sorted[index];
+}
@@ -0,0 +1,88 @@
+#ifndef ADAPTIVE_CONTROLLER_H
+#define ADAPTIVE_CONTROLLER_H
+
+#include "yolov5.h"
+#include "detector_factory.h"
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 分辨率档位 - 每个档位对应一个检测器会话
+struct ResolutionLevel {
+    std::string model_path;              // 固定尺寸导出的模型，或多个档位共用的动态尺寸模型
+    int input_size = 640;                // 输入边长（仅动态尺寸模型生效，需为 32 的倍数）
+    float confidence_threshold = 0.5f;   // 低档位可提高阈值以减少候选框
+    size_t max_candidates = 0;           // NMS 之前的候选框上限，0 表示不限制
+};
+
+// 控制器配置
+struct ControllerConfig {
+    std::vector<ResolutionLevel> levels;        // 按质量从高到低排列（档位 0 质量最高）
+    float nms_threshold = 0.4f;
+    double latency_target_ms = 50.0;            // p99 延迟目标
+    size_t window_size = 100;                   // 每路流统计 p99 的滑动窗口（帧）
+    size_t min_window_samples = 20;             // 窗口样本数不足时不做基于延迟的决策
+    size_t max_queue_depth = 8;                 // 队列深度超过该值时立即降级
+    double upgrade_ratio = 0.6;                 // 折算到上一档位的 p99 低于目标的该比例且队列为空时才升级（滞回）
+    size_t min_frames_between_switches = 30;    // 两次切换之间的最少帧数（滞回）
+    size_t min_frames_between_queue_switches = 5; // 队列积压触发的两次降级之间的最少帧数（滞回）
+};
+
+// 控制器统计指标
+struct ControllerStats {
+    std::vector<uint64_t> frames_per_level;     // 各档位处理的帧数
+    std::vector<double> p99_latency_ms;         // 各档位最近窗口的 p99 延迟
+    uint64_t upgrades = 0;                      // 升档次数
+    uint64_t downgrades = 0;                    // 降档次数（含队列积压）
+    uint64_t queue_downgrades = 0;              // 因队列积压触发的降档次数
+    std::unordered_map<int, int> stream_levels; // 每路流当前档位
+};
+
+// SLA 驱动的自适应分辨率控制器 - 按延迟目标和队列深度逐帧选择档位，降级而不丢帧
+class AdaptiveController {
+public:
+    // 各档位的检测器由工厂创建（共享权重），动态尺寸模型的多个档位共用同一模型文件
+    AdaptiveController(const ControllerConfig& config, DetectorFactory& factory);
+
+    // 禁用拷贝构造和赋值
+    AdaptiveController(const AdaptiveController&) = delete;
+    AdaptiveController& operator=(const AdaptiveController&) = delete;
+
+    // 以该路流当前档位检测一帧，queue_depth 为调用方该流待处理的帧数
+    std::vector<Detection> detect(int stream_id, const cv::Mat& image, size_t queue_depth);
+
+    bool is_ready() const;
+    int get_stream_level(int stream_id) const;
+    size_t get_num_levels() const;
+    cv::Size get_level_input_size(int level) const;
+    ControllerStats get_stats() const;
+
+private:
+    struct StreamState {
+        int level = 0;
+        std::deque<double> latencies;
+        size_t frames_since_switch = 0;
+    };
+
+    // 记录一帧延迟并决定下一帧的档位（调用方需持有锁）
+    void update_level_locked(int stream_id, StreamState& state, double latency_ms, size_t queue_depth);
+    void switch_level_locked(int stream_id, StreamState& state, int new_level,
+                             double p99_ms, size_t queue_depth, const char* reason);
+    static double percentile(const std::deque<double>& samples, double q);
+
+    ControllerConfig config_;
+    std::vector<std::unique_ptr<YOLOv5Detector>> detectors_;
+    bool ready_ = false;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<int, StreamState> streams_;
+    std::vector<std::deque<double>> level_latencies_;
+    ControllerStats stats_;
+};
+
+#endif // ADAPTIVE_CONTROLLER_H
@@ -0,0 +1,208 @@
+#include "async_detector.h"
+#include <algorithm>
+#include <iostream>
+
+class AsyncDetector::InferenceSlot {
+public:
+    explicit InferenceSlot(AsyncDetector& owner) : owner_(owner) {
+        owner_.acquire_inference_slot();
+    }
+    ~InferenceSlot() {
+        release();
+    }
+
+    // 禁用拷贝构造和赋值
+    InferenceSlot(const InferenceSlot&) = delete;
+    InferenceSlot& operator=(const InferenceSlot&) = delete;
+
+    void release() {
+        if (!released_) {
+            released_ = true;
+            owner_.release_inference_slot();
+        }
+    }
+
+private:
+    AsyncDetector& owner_;
+    bool released_ = false;
+};
+
+CancellationToken::CancellationToken()
+    : cancelled_(std::make_shared<std::atomic<bool>>(false)) {}
+
+void CancellationToken::cancel() {
+    cancelled_->store(true);
+}
+
+bool CancellationToken::is_cancelled() const {
+    return cancelled_->load();
+}
+
+AsyncDetector::AsyncDetector(YOLOv5Detector& detector, size_t max_concurrency, size_t max_pending)
+    : detector_(detector),
+      max_concurrency_(std::max<size_t>(1, max_concurrency)),
+      executor_(max_concurrency_, max_pending, [placement = detector.get_thread_placement()]() {
+          // 工作线程只绑定一次：使用整个节点的 CPU，而不是 detect() 调用线程的单个 CPU，
+          // 否则所有工作线程挤在同一个核心上，失去并发；预处理、推理输入缓冲区和后处理都在本节点
+          if (placement.is_pinned()) {
+              pin_current_thread(placement.node_cpus.empty() ? placement.pipeline_cpus : placement.node_cpus);
+              prefer_numa_node(placement.numa_node);
+          }
+      }) {}
+
+AsyncDetector::~AsyncDetector() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_cv_.wait(lock, [this]() { return in_flight_ == 0; });
+}
+
+std::future<std::vector<Detection>> AsyncDetector::detect_async(const cv::Mat& image,
+                                                                CancellationToken token) {
+    auto promise = std::make_shared<std::promise<std::vector<Detection>>>();
+    std::future<std::vector<Detection>> future = promise->get_future();
+
+    bool accepted = detect_async(
+        image,
+        [promise](std::vector<Detection> detections, std::exception_ptr error) {
+            if (error) {
+                promise->set_exception(error);
+            } else {
+                promise->set_value(std::move(detections));
+            }
+        },
+        std::move(token));
+
+    if (!accepted) {
+        promise->set_exception(std::make_exception_ptr(std::runtime_error("异步检测队列已满")));
+    }
+    return future;
+}
+
+bool AsyncDetector::detect_async(const cv::Mat& image, Callback callback, CancellationToken token) {
+    auto shared_callback = std::make_shared<Callback>(std::move(callback));
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        in_flight_++;
+    }
+
+    // 调用方可能复用图像缓冲区，这里保留一份引用计数拷贝即可（cv::Mat 浅拷贝）
+    bool accepted = executor_.submit([this, image, shared_callback, token]() {
+        try {
+            run_request(image, shared_callback, token);
+        } catch (...) {
+            complete(shared_callback, {}, std::current_exception());
+        }
+    });
+
+    if (!accepted) {
+        finish_request();
+    }
+    return accepted;
+}
+
+size_t AsyncDetector::get_in_flight() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return in_flight_;
+}
+
+size_t AsyncDetector::get_max_concurrency() const {
+    return max_concurrency_;
+}
+
+YOLOv5Detector& AsyncDetector::get_detector() {
+    return detector_;
+}
+
+void AsyncDetector::run_request(const cv::Mat& image, const std::shared_ptr<Callback>& callback,
+                                const CancellationToken& token) {
+    if (token.is_cancelled()) {
+        complete(callback, {}, std::make_exception_ptr(DetectionCancelled()));
+        return;
+    }
+
+    cv::Mat preprocessed = detector_.preprocess(image);
+    if (preprocessed.empty()) {
+        complete(callback, {}, std::make_exception_ptr(std::runtime_error("预处理失败")));
+        return;
+    }
+
+    // 限制同时推理的帧数；在拿到名额后再检查一次取消
+    auto slot = std::make_shared<InferenceSlot>(*this);
+    if (token.is_cancelled()) {
+        slot->release();
+        complete(callback, {}, std::make_exception_ptr(DetectionCancelled()));
+        return;
+    }
+
+    // 名额交给 ORT 回调，推理完成后在 ORT 线程上释放；推理未能启动或抛出异常时随回调一起销毁并归还
+    // 后处理交回执行器，避免占用 ORT 线程池
+    bool started = detector_.inference_async(
+        preprocessed,
+        [this, slot, image, callback, token](std::vector<float> output, const std::string& error) {
+            slot->release();
+            executor_.post([this, output = std::move(output), error, image, callback, token]() mutable {
+                try {
+                    finish_postprocess(std::move(output), error, image, callback, token);
+                } catch (...) {
+                    complete(callback, {}, std::current_exception());
+                }
+            });
+        });
+
+    if (!started) {
+        // 会话不支持 RunAsync（单线程）时退回同步推理
+        std::vector<float> output = detector_.inference(preprocessed);
+        slot->release();
+        std::string error = output.empty() ? "推理失败" : "";
+        finish_postprocess(std::move(output), error, image, callback, token);
+    }
+}
+
+void AsyncDetector::finish_postprocess(std::vector<float> output, const std::string& error, const cv::Mat& image,
+                                       const std::shared_ptr<Callback>& callback, const CancellationToken& token) {
+    if (!error.empty()) {
+        complete(callback, {}, std::make_exception_ptr(std::runtime_error(error)));
+        return;
+    }
+    if (token.is_cancelled()) {
+        complete(callback, {}, std::make_exception_ptr(DetectionCancelled()));
+        return;
+    }
+
+    std::vector<Detection> detections = detector_.postprocess(output, image);
+    complete(callback, std::move(detections), nullptr);
+}
+
+void AsyncDetector::complete(const std::shared_ptr<Callback>& callback, std::vector<Detection> detections,
+                             std::exception_ptr error) {
+    // 用户回调抛出的任何异常都在这里吞掉，否则外层会再次调用 complete()，回调执行两次且计数减两次
+    try {
+        (*callback)(std::move(detections), error);
+    } catch (const std::exception& e) {
+        std::cerr << "检测回调异常: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "检测回调异常: 未知异常" << std::endl;
+    }
+    finish_request();
+}
+
+void AsyncDetector::acquire_inference_slot() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    slot_cv_.wait(lock, [this]() { return active_inferences_ < max_concurrency_; });
+    active_inferences_++;
+}
+
+void AsyncDetector::release_inference_slot() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        active_inferences_--;
+    }
+    slot_cv_.notify_one();
+}
+
+void AsyncDetector::finish_request() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        in_flight_--;
+    }
+    idle_cv_.notify_all();
+}
@@ -0,0 +1,140 @@
+#ifndef ASYNC_DETECTOR_H
+#define ASYNC_DETECTOR_H
+
+#include "yolov5.h"
+#include "detect_executor.h"
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+#if defined(__cpp_impl_coroutine)
+#include <coroutine>
+#endif
+
+// 取消令牌 - 可拷贝，所有副本共享同一个取消标志
+// 取消在各阶段之间检查；已提交给 ORT 的推理会执行完，但结果不再后处理
+class CancellationToken {
+public:
+    CancellationToken();
+
+    void cancel();
+    bool is_cancelled() const;
+
+private:
+    std::shared_ptr<std::atomic<bool>> cancelled_;
+};
+
+// 请求被取消时通过 future / 回调 / co_await 抛出
+class DetectionCancelled : public std::runtime_error {
+public:
+    DetectionCancelled() : std::runtime_error("检测请求已取消") {}
+};
+
+// 异步检测器 - 包装一个 YOLOv5Detector，提供 future、回调和协程三种接口
+// 预处理和后处理在内部执行器上运行，推理使用 ORT RunAsync，
+// 同时处于推理阶段的帧数不超过 max_concurrency，排队请求不超过 max_pending
+// 检测器绑定到 NUMA 节点时，执行器线程启动时绑定到该节点的全部 CPU 并优先从该节点分配内存
+class AsyncDetector {
+public:
+    // 回调参数：检测结果，或出错/取消时的异常（此时结果为空）
+    using Callback = std::function<void(std::vector<Detection>, std::exception_ptr)>;
+
+    AsyncDetector(YOLOv5Detector& detector, size_t max_concurrency = 2, size_t max_pending = 256);
+    // 等待所有已提交的请求完成
+    ~AsyncDetector();
+
+    // 禁用拷贝构造和赋值
+    AsyncDetector(const AsyncDetector&) = delete;
+    AsyncDetector& operator=(const AsyncDetector&) = delete;
+
+    // future 接口；队列已满时返回的 future 携带异常
+    std::future<std::vector<Detection>> detect_async(const cv::Mat& image,
+                                                     CancellationToken token = CancellationToken());
+
+    // 回调接口；队列已满时返回 false 且不会调用 callback
+    // callback 在执行器线程上调用，不应长时间阻塞
+    bool detect_async(const cv::Mat& image, Callback callback,
+                      CancellationToken token = CancellationToken());
+
+    size_t get_in_flight() const;
+    size_t get_max_concurrency() const;
+    YOLOv5Detector& get_detector();
+
+private:
+    // 推理名额 - 构造时占用，release() 或析构时归还，保证任何异常路径都不会泄漏名额
+    class InferenceSlot;
+    friend class DetectAwaitable;
+
+    void run_request(const cv::Mat& image, const std::shared_ptr<Callback>& callback,
+                     const CancellationToken& token);
+    void finish_postprocess(std::vector<float> output, const std::string& error, const cv::Mat& image,
+                            const std::shared_ptr<Callback>& callback, const CancellationToken& token);
+    void complete(const std::shared_ptr<Callback>& callback, std::vector<Detection> detections,
+                  std::exception_ptr error);
+    void acquire_inference_slot();
+    void release_inference_slot();
+    void finish_request();
+
+    YOLOv5Detector& detector_;
+    size_t max_concurrency_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable slot_cv_;
+    std::condition_variable idle_cv_;
+    size_t active_inferences_ = 0;
+    size_t in_flight_ = 0;
+
+    // 最后声明，析构时最先停止工作线程
+    DetectExecutor executor_;
+};
+
+#if defined(__cpp_impl_coroutine)
+// 协程接口：auto detections = co_await DetectAwaitable(async_detector, image);
+// 协程在执行器线程上恢复；队列已满时不挂起，直接在 await_resume 中抛出异常
+// 恢复作为单独的任务投递，此时请求已计数完成，协程中可以销毁 AsyncDetector
+class DetectAwaitable {
+public:
+    DetectAwaitable(AsyncDetector& detector, const cv::Mat& image,
+                    CancellationToken token = CancellationToken())
+        : detector_(detector), image_(image), token_(std::move(token)) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> handle) {
+        bool accepted = detector_.detect_async(
+            image_,
+            [this, handle](std::vector<Detection> detections, std::exception_ptr error) {
+                detections_ = std::move(detections);
+                error_ = error;
+                // 不能在回调中直接恢复：回调返回后检测器才完成计数，协程若销毁检测器会在析构中等待自己
+                detector_.executor_.post([handle]() { handle.resume(); });
+            },
+            token_);
+        if (!accepted) {
+            error_ = std::make_exception_ptr(std::runtime_error("异步检测队列已满"));
+        }
+        return accepted;
+    }
+
+    std::vector<Detection> await_resume() {
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+        return std::move(detections_);
+    }
+
+private:
+    AsyncDetector& detector_;
+    cv::Mat image_;
+    CancellationToken token_;
+    std::vector<Detection> detections_;
+    std::exception_ptr error_;
+};
+#endif
+
+#endif // ASYNC_DETECTOR_H
@@ -0,0 +1,255 @@
+#include "cascade_detector.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+double CascadeStats::escalation_rate() const {
+    return frames > 0 ? static_cast<double>(escalated_frames) / frames : 0.0;
+}
+
+CascadeDetector::CascadeDetector(const CascadeConfig& config, DetectorFactory& factory)
+    : config_(config) {
+    if (config_.uncertain_low >= config_.uncertain_high) {
+        std::cerr << "错误: 不确定区间下限 " << config_.uncertain_low
+                  << " 必须小于上限 " << config_.uncertain_high << std::endl;
+        return;
+    }
+
+    // 第一级阈值不高于区间下限，才能拿到不确定区间内的检测框
+    float small_threshold = std::min(config_.uncertain_low, config_.confidence_threshold);
+    small_detector_ = factory.create(config_.small_model_path, small_threshold, config_.nms_threshold);
+    large_detector_ = factory.create(config_.large_model_path, config_.confidence_threshold, config_.nms_threshold);
+    ready_ = small_detector_->is_model_loaded() && large_detector_->is_model_loaded();
+}
+
+std::vector<Detection> CascadeDetector::detect(const cv::Mat& image) {
+    if (!ready_ || image.empty()) {
+        std::cerr << "错误: 级联检测器未就绪或输入图像为空" << std::endl;
+        return {};
+    }
+
+    // 第一级：小模型全图检测
+    auto small_start = std::chrono::high_resolution_clock::now();
+    std::vector<Detection> first_stage = small_detector_->detect(image);
+    auto small_end = std::chrono::high_resolution_clock::now();
+
+    std::vector<Detection> fused;
+    std::vector<Detection> uncertain;
+    for (const auto& det : first_stage) {
+        // 低于区间下限的只在最终阈值更低时出现（如 mAP 评估），不升级，原样参与融合
+        bool in_band = det.confidence >= config_.uncertain_low && det.confidence < config_.uncertain_high;
+        (in_band ? uncertain : fused).push_back(det);
+    }
+
+    // 第二级：复核不确定区域
+    bool full_frame = false;
+    size_t num_crops = 0;
+    size_t skipped = 0;
+    if (!uncertain.empty()) {
+        std::vector<cv::Rect> regions = build_regions(uncertain, image.size());
+
+        double region_area = 0.0;
+        for (const auto& region : regions) {
+            region_area += region.area();
+        }
+        bool over_budget = regions.size() > config_.max_crops_per_frame;
+        bool large_cluster = region_area >= config_.full_frame_area_ratio * image.size().area();
+
+        if (config_.allow_full_frame && (over_budget || large_cluster)) {
+            // 不确定区域过多或过大，裁剪拼图已不划算，直接整帧检测；不确定的第一级结果全部由第二级替代
+            full_frame = true;
+            std::vector<Detection> second_stage = large_detector_->detect(image);
+            fused.insert(fused.end(), second_stage.begin(), second_stage.end());
+        } else {
+            // 超出预算的区域保留第一级结果，由最终阈值决定去留
+            if (over_budget) {
+                skipped = regions.size() - config_.max_crops_per_frame;
+                regions.resize(config_.max_crops_per_frame);
+            }
+            num_crops = regions.size();
+
+            for (const auto& det : uncertain) {
+                cv::Point center(det.box.x + det.box.width / 2, det.box.y + det.box.height / 2);
+                bool escalated = std::any_of(regions.begin(), regions.end(),
+                                             [&](const cv::Rect& region) { return region.contains(center); });
+                if (!escalated) {
+                    fused.push_back(det);
+                }
+            }
+
+            if (!regions.empty()) {
+                std::vector<Detection> second_stage = detect_regions(image, regions);
+                fused.insert(fused.end(), second_stage.begin(), second_stage.end());
+            }
+        }
+    }
+    auto large_end = std::chrono::high_resolution_clock::now();
+
+    // 融合：按最终阈值过滤后统一做 NMS，两级重复的框保留置信度更高的一个
+    std::vector<Detection> result = large_detector_->select_detections(fused);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.frames++;
+        stats_.uncertain_detections += uncertain.size();
+        stats_.skipped_regions += skipped;
+        if (full_frame || num_crops > 0) {
+            stats_.escalated_frames++;
+            if (full_frame) {
+                stats_.full_frame_escalations++;
+            } else {
+                stats_.crop_escalations++;
+                stats_.crops += num_crops;
+            }
+        }
+        stats_.small_ms_total +=
+            std::chrono::duration_cast<std::chrono::microseconds>(small_end - small_start).count() / 1000.0;
+        stats_.large_ms_total +=
+            std::chrono::duration_cast<std::chrono::microseconds>(large_end - small_end).count() / 1000.0;
+    }
+
+    return result;
+}
+
+bool CascadeDetector::is_ready() const {
+    return ready_;
+}
+
+const CascadeConfig& CascadeDetector::get_config() const {
+    return config_;
+}
+
+CascadeStats CascadeDetector::get_stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void CascadeDetector::reset_stats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_ = CascadeStats();
+}
+
+std::vector<cv::Rect> CascadeDetector::build_regions(const std::vector<Detection>& uncertain,
+                                                     const cv::Size& image_size) const {
+    struct Cluster {
+        cv::Rect rect;
+        size_t count;
+    };
+
+    const cv::Rect bounds(0, 0, image_size.width, image_size.height);
+    std::vector<Cluster> clusters;
+    for (const auto& det : uncertain) {
+        int pad_x = static_cast<int>(det.box.width * config_.crop_padding);
+        int pad_y = static_cast<int>(det.box.height * config_.crop_padding);
+        cv::Rect rect(det.box.x - pad_x, det.box.y - pad_y, det.box.width + 2 * pad_x, det.box.height + 2 * pad_y);
+
+        // 过小的目标以中心向外扩展到最小边长，保证第二级有足够的上下文
+        if (rect.width < config_.min_crop_size) {
+            rect.x -= (config_.min_crop_size - rect.width) / 2;
+            rect.width = config_.min_crop_size;
+        }
+        if (rect.height < config_.min_crop_size) {
+            rect.y -= (config_.min_crop_size - rect.height) / 2;
+            rect.height = config_.min_crop_size;
+        }
+
+        rect &= bounds;
+        if (rect.area() > 0) {
+            clusters.push_back({rect, 1});
+        }
+    }
+
+    // 相交的区域合并为一个（聚集的低置信度目标作为一个整体复核）
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (size_t i = 0; i < clusters.size() && !merged; ++i) {
+            for (size_t j = i + 1; j < clusters.size(); ++j) {
+                if ((clusters[i].rect & clusters[j].rect).area() > 0) {
+                    clusters[i].rect |= clusters[j].rect;
+                    clusters[i].count += clusters[j].count;
+                    clusters.erase(clusters.begin() + j);
+                    merged = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    std::stable_sort(clusters.begin(), clusters.end(),
+                     [](const Cluster& a, const Cluster& b) { return a.count > b.count; });
+
+    std::vector<cv::Rect> regions;
+    regions.reserve(clusters.size());
+    for (const auto& cluster : clusters) {
+        regions.push_back(cluster.rect);
+    }
+    return regions;
+}
+
+std::vector<Detection> CascadeDetector::detect_regions(const cv::Mat& image, const std::vector<cv::Rect>& regions) {
+    ScopedThreadPlacement scoped_placement(large_detector_->get_thread_placement());
+
+    // 按网格把各区域等比缩放后拼到一张第二级输入尺寸的图上，空白处填充黑色（与 preprocess_image 的零填充一致）
+    // 无论区域多小、多少，拼图都按第二级的完整输入尺寸推理，耗时与整帧升级相同
+    cv::Size input_size = large_detector_->get_input_size();
+    int grid = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(regions.size()))));
+    int cell_width = input_size.width / grid;
+    int cell_height = input_size.height / grid;
+
+    cv::Mat mosaic = cv::Mat::zeros(input_size.height, input_size.width, image.type());
+    std::vector<MosaicTile> tiles;
+    tiles.reserve(regions.size());
+    for (size_t i = 0; i < regions.size(); ++i) {
+        MosaicTile tile;
+        tile.region = regions[i];
+        tile.scale = std::min(float(cell_width) / tile.region.width, float(cell_height) / tile.region.height);
+
+        int tile_width = std::max(1, static_cast<int>(tile.region.width * tile.scale));
+        int tile_height = std::max(1, static_cast<int>(tile.region.height * tile.scale));
+        int row = static_cast<int>(i) / grid;
+        int col = static_cast<int>(i) % grid;
+        tile.tile = cv::Rect(col * cell_width + (cell_width - tile_width) / 2,
+                             row * cell_height + (cell_height - tile_height) / 2,
+                             tile_width, tile_height);
+
+        cv::Mat resized;
+        cv::resize(image(tile.region), resized, tile.tile.size());
+        resized.copyTo(mosaic(tile.tile));
+        tiles.push_back(tile);
+    }
+
+    cv::Mat preprocessed = large_detector_->preprocess(mosaic);
+    if (preprocessed.empty()) {
+        return {};
+    }
+    std::vector<float> output = large_detector_->inference(preprocessed);
+    std::vector<Detection> candidates =
+        large_detector_->extract_candidates(output, mosaic, config_.confidence_threshold);
+
+    // 按中心点归属到拼图块，裁剪到块内后映射回原图坐标；跨块的框只属于中心所在的块
+    std::vector<Detection> detections;
+    for (const auto& candidate : candidates) {
+        cv::Point center(candidate.box.x + candidate.box.width / 2, candidate.box.y + candidate.box.height / 2);
+        auto it = std::find_if(tiles.begin(), tiles.end(),
+                               [&](const MosaicTile& tile) { return tile.tile.contains(center); });
+        if (it == tiles.end()) {
+            continue;
+        }
+
+        cv::Rect box = candidate.box & it->tile;
+        if (box.area() <= 0) {
+            continue;
+        }
+
+        Detection det = candidate;
+        det.box = cv::Rect(it->region.x + static_cast<int>((box.x - it->tile.x) / it->scale),
+                           it->region.y + static_cast<int>((box.y - it->tile.y) / it->scale),
+                           static_cast<int>(box.width / it->scale),
+                           static_cast<int>(box.height / it->scale)) & it->region;
+        detections.push_back(det);
+    }
+
+    return detections;
+}
@@ -0,0 +1,84 @@
+#ifndef CASCADE_DETECTOR_H
+#define CASCADE_DETECTOR_H
+
+#include "yolov5.h"
+#include "detector_factory.h"
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 级联配置
+// 成本说明：任何一帧只要升级（裁剪拼图或整帧），都要做一次完整输入尺寸的第二级推理，
+// 拼图不会因区域小而变便宜；因此平均耗时约为 第一级耗时 + 升级率 × 第二级耗时，调节区间和预算时应以升级率为准
+struct CascadeConfig {
+    std::string small_model_path;           // 第一级模型（如 yolov5n），每帧全图运行
+    std::string large_model_path;           // 第二级模型（如 yolov5s/m），只处理不确定区域
+    float confidence_threshold = 0.5f;      // 融合结果的最终置信度阈值
+    float nms_threshold = 0.4f;
+    float uncertain_low = 0.25f;            // 不确定区间 [low, high)：低于 low 的不升级
+    float uncertain_high = 0.6f;            // 不低于 high 的第一级结果直接采用
+    size_t max_crops_per_frame = 4;         // 每帧升级预算（送入第二级的裁剪区域数，只影响拼图精度，不影响第二级耗时）
+    bool allow_full_frame = true;           // 超出预算或不确定区域过大时改为第二级整帧检测
+    float full_frame_area_ratio = 0.4f;     // 不确定区域总面积超过画面该比例时整帧检测
+    float crop_padding = 0.25f;             // 裁剪区域向四周扩展的比例（保留上下文）
+    int min_crop_size = 96;                 // 裁剪区域最小边长（像素）
+};
+
+// 级联统计指标
+struct CascadeStats {
+    uint64_t frames = 0;
+    uint64_t escalated_frames = 0;          // 运行了第二级模型的帧数（每帧一次完整尺寸推理）
+    uint64_t crop_escalations = 0;          // 以裁剪拼图方式升级的帧数
+    uint64_t full_frame_escalations = 0;    // 整帧升级的帧数
+    uint64_t crops = 0;                     // 送入第二级的裁剪区域总数
+    uint64_t uncertain_detections = 0;      // 落在不确定区间的第一级检测数
+    uint64_t skipped_regions = 0;           // 因预算不足未升级的区域数（保留第一级结果）
+    double small_ms_total = 0.0;            // 第一级耗时累计
+    double large_ms_total = 0.0;            // 第二级耗时累计
+
+    double escalation_rate() const;
+};
+
+// 两级模型级联检测器 - 小模型全图检测，置信度处于不确定区间的区域交给大模型复核
+// 多个裁剪区域拼成一张图做一次第二级推理（导出模型的 batch 维固定为 1），再映射回原图与第一级结果融合
+class CascadeDetector {
+public:
+    // 两级检测器由工厂创建（共享权重）
+    CascadeDetector(const CascadeConfig& config, DetectorFactory& factory);
+
+    // 禁用拷贝构造和赋值
+    CascadeDetector(const CascadeDetector&) = delete;
+    CascadeDetector& operator=(const CascadeDetector&) = delete;
+
+    std::vector<Detection> detect(const cv::Mat& image);
+
+    bool is_ready() const;
+    const CascadeConfig& get_config() const;
+    CascadeStats get_stats() const;
+    void reset_stats();
+
+private:
+    // 拼图中的一个裁剪区域：原图区域 region 缩放 scale 后放在拼图的 tile 位置
+    struct MosaicTile {
+        cv::Rect region;
+        cv::Rect tile;
+        float scale = 1.0f;
+    };
+
+    // 将不确定检测框扩展后合并为互不重叠的区域，按包含的检测数从多到少排序
+    std::vector<cv::Rect> build_regions(const std::vector<Detection>& uncertain, const cv::Size& image_size) const;
+    std::vector<Detection> detect_regions(const cv::Mat& image, const std::vector<cv::Rect>& regions);
+
+    CascadeConfig config_;
+    std::unique_ptr<YOLOv5Detector> small_detector_;
+    std::unique_ptr<YOLOv5Detector> large_detector_;
+    bool ready_ = false;
+
+    mutable std::mutex mutex_;
+    CascadeStats stats_;
+};
+
+#endif // CASCADE_DETECTOR_H
@@ -0,0 +1,253 @@
+#include "coco_evaluator.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+
+bool CocoEvaluator::load_annotations(const std::string& annotation_path,
+                                     const std::vector<std::string>& class_names) {
+    std::ifstream file(annotation_path);
+    if (!file.is_open()) {
+        std::cerr << "错误: 无法打开标注文件 " << annotation_path << std::endl;
+        return false;
+    }
+
+    nlohmann::json root;
+    try {
+        file >> root;
+    } catch (const nlohmann::json::exception& e) {
+        std::cerr << "标注文件解析失败: " << e.what() << std::endl;
+        return false;
+    }
+
+    images_.clear();
+    ground_truth_.clear();
+    detections_.clear();
+    evaluated_images_.clear();
+    class_names_ = class_names;
+
+    try {
+        // 按名称映射类别（COCO 的 category_id 1~90 不连续）
+        std::unordered_map<std::string, int> name_to_class;
+        for (size_t i = 0; i < class_names.size(); ++i) {
+            name_to_class[class_names[i]] = static_cast<int>(i);
+        }
+
+        std::unordered_map<int, int> category_to_class;
+        for (const auto& category : root.at("categories")) {
+            std::string name = category.at("name").get<std::string>();
+            auto it = name_to_class.find(name);
+            if (it == name_to_class.end()) {
+                std::cerr << "警告: 类别 \"" << name << "\" 不在模型类别中，忽略其标注" << std::endl;
+                continue;
+            }
+            category_to_class[category.at("id").get<int>()] = it->second;
+        }
+
+        for (const auto& image : root.at("images")) {
+            CocoImage info;
+            info.id = image.at("id").get<int>();
+            info.file_name = image.at("file_name").get<std::string>();
+            info.width = image.value("width", 0);
+            info.height = image.value("height", 0);
+            images_.push_back(info);
+        }
+
+        for (const auto& annotation : root.at("annotations")) {
+            auto it = category_to_class.find(annotation.at("category_id").get<int>());
+            if (it == category_to_class.end()) continue;
+
+            const auto& bbox = annotation.at("bbox");
+            CocoAnnotation gt;
+            gt.image_id = annotation.at("image_id").get<int>();
+            gt.class_id = it->second;
+            gt.box = cv::Rect2f(bbox.at(0).get<float>(), bbox.at(1).get<float>(),
+                                bbox.at(2).get<float>(), bbox.at(3).get<float>());
+            gt.iscrowd = annotation.value("iscrowd", 0) != 0;
+            ground_truth_[gt.image_id].push_back(gt);
+        }
+    } catch (const nlohmann::json::exception& e) {
+        std::cerr << "标注文件格式错误: " << e.what() << std::endl;
+        return false;
+    }
+
+    std::cout << "COCO 标注加载成功: " << images_.size() << " 张图像" << std::endl;
+    return true;
+}
+
+const std::vector<CocoImage>& CocoEvaluator::get_images() const {
+    return images_;
+}
+
+void CocoEvaluator::add_detections(int image_id, const std::vector<Detection>& detections) {
+    evaluated_images_.insert(image_id);
+    auto& stored = detections_[image_id];
+    stored.insert(stored.end(), detections.begin(), detections.end());
+}
+
+void CocoEvaluator::reset_detections() {
+    detections_.clear();
+    evaluated_images_.clear();
+}
+
+EvaluationResult CocoEvaluator::evaluate() const {
+    EvaluationResult result;
+
+    // 统计已评估图像中每个类别的非 crowd 标注数量
+    std::vector<int> num_ground_truth(class_names_.size(), 0);
+    for (int image_id : evaluated_images_) {
+        auto gt_it = ground_truth_.find(image_id);
+        if (gt_it == ground_truth_.end()) continue;
+        for (const auto& gt : gt_it->second) {
+            if (!gt.iscrowd && gt.class_id >= 0 && gt.class_id < static_cast<int>(num_ground_truth.size())) {
+                num_ground_truth[gt.class_id]++;
+            }
+        }
+    }
+
+    for (size_t c = 0; c < class_names_.size(); ++c) {
+        // 与 COCO 一致：没有标注的类别不参与平均
+        if (num_ground_truth[c] == 0) continue;
+
+        ClassAP class_ap;
+        class_ap.class_id = static_cast<int>(c);
+        class_ap.class_name = class_names_[c];
+        class_ap.num_ground_truth = num_ground_truth[c];
+
+        double ap_sum = 0.0;
+        for (int t = 0; t < 10; ++t) {
+            float iou_threshold = 0.5f + 0.05f * t;
+            double ap = compute_class_ap(class_ap.class_id, iou_threshold, num_ground_truth[c]);
+            if (t == 0) class_ap.ap50 = ap;
+            ap_sum += ap;
+        }
+        class_ap.ap50_95 = ap_sum / 10.0;
+
+        result.per_class.push_back(class_ap);
+    }
+
+    if (!result.per_class.empty()) {
+        for (const auto& class_ap : result.per_class) {
+            result.map50 += class_ap.ap50;
+            result.map50_95 += class_ap.ap50_95;
+        }
+        result.map50 /= result.per_class.size();
+        result.map50_95 /= result.per_class.size();
+    }
+
+    return result;
+}
+
+double CocoEvaluator::compute_class_ap(int class_id, float iou_threshold, int num_ground_truth) const {
+    std::vector<ScoredMatch> matches;
+
+    for (int image_id : evaluated_images_) {
+        // 当前图像中该类别的检测框，按置信度降序，最多保留 100 个
+        std::vector<Detection> dets;
+        auto det_it = detections_.find(image_id);
+        if (det_it != detections_.end()) {
+            for (const auto& det : det_it->second) {
+                if (det.class_id == class_id) dets.push_back(det);
+            }
+        }
+        if (dets.empty()) continue;
+
+        std::stable_sort(dets.begin(), dets.end(),
+                         [](const Detection& a, const Detection& b) { return a.confidence > b.confidence; });
+        if (dets.size() > static_cast<size_t>(max_detections_per_image_)) {
+            dets.resize(max_detections_per_image_);
+        }
+
+        std::vector<const CocoAnnotation*> gts;
+        auto gt_it = ground_truth_.find(image_id);
+        if (gt_it != ground_truth_.end()) {
+            for (const auto& gt : gt_it->second) {
+                if (gt.class_id == class_id) gts.push_back(&gt);
+            }
+        }
+        std::vector<bool> matched(gts.size(), false);
+
+        for (const auto& det : dets) {
+            cv::Rect2f det_box(float(det.box.x), float(det.box.y), float(det.box.width), float(det.box.height));
+
+            // 优先匹配 IoU 最大且未被匹配的非 crowd 标注
+            int best_gt = -1;
+            float best_iou = iou_threshold;
+            for (size_t g = 0; g < gts.size(); ++g) {
+                if (gts[g]->iscrowd || matched[g]) continue;
+                float iou = compute_iou(det_box, gts[g]->box, false);
+                if (iou >= best_iou) {
+                    best_iou = iou;
+                    best_gt = static_cast<int>(g);
+                }
+            }
+
+            if (best_gt >= 0) {
+                matched[best_gt] = true;
+                matches.push_back({det.confidence, true});
+                continue;
+            }
+
+            // 与 crowd 区域重叠的检测框既不算 TP 也不算 FP
+            bool ignored = false;
+            for (const auto* gt : gts) {
+                if (gt->iscrowd && compute_iou(det_box, gt->box, true) >= iou_threshold) {
+                    ignored = true;
+                    break;
+                }
+            }
+            if (!ignored) {
+                matches.push_back({det.confidence, false});
+            }
+        }
+    }
+
+    return interpolated_ap(matches, num_ground_truth);
+}
+
+double CocoEvaluator::interpolated_ap(std::vector<ScoredMatch>& matches, int num_ground_truth) {
+    if (matches.empty() || num_ground_truth == 0) {
+        return 0.0;
+    }
+
+    std::stable_sort(matches.begin(), matches.end(),
+                     [](const ScoredMatch& a, const ScoredMatch& b) { return a.score > b.score; });
+
+    std::vector<double> precision(matches.size());
+    std::vector<double> recall(matches.size());
+    int tp = 0, fp = 0;
+    for (size_t i = 0; i < matches.size(); ++i) {
+        if (matches[i].true_positive) tp++; else fp++;
+        precision[i] = double(tp) / (tp + fp);
+        recall[i] = double(tp) / num_ground_truth;
+    }
+
+    // 精度包络：从右向左取最大值
+    for (size_t i = precision.size() - 1; i > 0; --i) {
+        precision[i - 1] = std::max(precision[i - 1], precision[i]);
+    }
+
+    // 101 点插值
+    double ap = 0.0;
+    for (int r = 0; r <= 100; ++r) {
+        double recall_threshold = r / 100.0;
+        auto it = std::lower_bound(recall.begin(), recall.end(), recall_threshold);
+        if (it != recall.end()) {
+            ap += precision[it - recall.begin()];
+        }
+    }
+    return ap / 101.0;
+}
+
+float CocoEvaluator::compute_iou(const cv::Rect2f& a, const cv::Rect2f& b, bool crowd) {
+    float x1 = std::max(a.x, b.x);
+    float y1 = std::max(a.y, b.y);
+    float x2 = std::min(a.x + a.width, b.x + b.width);
+    float y2 = std::min(a.y + a.height, b.y + b.height);
+
+    float intersection = std::max(0.0f, x2 - x1) * std::max(0.0f, y2 - y1);
+    // crowd 标注的 IoU 分母只使用检测框面积（与 pycocotools 一致）
+    float union_area = crowd ? a.area() : a.area() + b.area() - intersection;
+    return union_area > 0.0f ? intersection / union_area : 0.0f;
+}
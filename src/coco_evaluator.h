@@ -0,0 +1,84 @@
+#ifndef COCO_EVALUATOR_H
+#define COCO_EVALUATOR_H
+
+#include "yolov5.h"
+#include <opencv2/opencv.hpp>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// COCO 数据集图像信息
+struct CocoImage {
+    int id = 0;
+    std::string file_name;
+    int width = 0;
+    int height = 0;
+};
+
+// COCO 标注框（category_id 已映射为模型类别索引）
+struct CocoAnnotation {
+    int image_id = 0;
+    int class_id = -1;
+    cv::Rect2f box;
+    bool iscrowd = false;
+};
+
+// 单个类别的 AP
+struct ClassAP {
+    int class_id = -1;
+    std::string class_name;
+    int num_ground_truth = 0;
+    double ap50 = 0.0;        // AP@0.5
+    double ap50_95 = 0.0;     // AP@0.5:0.95
+};
+
+// 评估结果
+struct EvaluationResult {
+    double map50 = 0.0;       // mAP@0.5
+    double map50_95 = 0.0;    // mAP@0.5:0.95
+    std::vector<ClassAP> per_class;   // 仅包含有标注的类别
+};
+
+// COCO 风格 mAP 评估器 - 101 点插值，IoU 阈值 0.50:0.05:0.95，每图每类最多 100 个检测框
+class CocoEvaluator {
+public:
+    CocoEvaluator() = default;
+
+    // 加载 COCO 格式标注文件，按类别名称将 category_id 映射到模型类别索引
+    bool load_annotations(const std::string& annotation_path,
+                          const std::vector<std::string>& class_names);
+
+    const std::vector<CocoImage>& get_images() const;
+
+    // 记录某张图像的检测结果（坐标为原图坐标），同时标记该图像已评估
+    // 没有检测结果的图像也需调用（传入空列表），否则其标注不计入召回率分母
+    void add_detections(int image_id, const std::vector<Detection>& detections);
+
+    // 清空已记录的检测结果和已评估图像，用于评估下一组配置
+    void reset_detections();
+
+    // 只统计已评估图像（--max-images 截断或读取失败的图像不参与）
+    EvaluationResult evaluate() const;
+
+private:
+    struct ScoredMatch {
+        float score;
+        bool true_positive;
+    };
+
+    double compute_class_ap(int class_id, float iou_threshold, int num_ground_truth) const;
+    static double interpolated_ap(std::vector<ScoredMatch>& matches, int num_ground_truth);
+    static float compute_iou(const cv::Rect2f& a, const cv::Rect2f& b, bool crowd);
+
+    std::vector<CocoImage> images_;
+    std::vector<std::string> class_names_;
+    // image_id -> 标注 / 检测结果
+    std::map<int, std::vector<CocoAnnotation>> ground_truth_;
+    std::map<int, std::vector<Detection>> detections_;
+    std::set<int> evaluated_images_;
+
+    static constexpr int max_detections_per_image_ = 100;
+};
+
+#endif // COCO_EVALUATOR_H
@@ -0,0 +1,97 @@
+#include "detect_executor.h"
+#include <algorithm>
+#include <exception>
+#include <iostream>
+
+DetectExecutor::DetectExecutor(size_t num_threads, size_t max_pending, std::function<void()> on_thread_start)
+    : max_pending_(std::max<size_t>(1, max_pending)), state_(std::make_shared<State>()) {
+    num_threads = std::max<size_t>(1, num_threads);
+    workers_.reserve(num_threads);
+    for (size_t i = 0; i < num_threads; ++i) {
+        workers_.emplace_back(&DetectExecutor::worker_loop, state_, on_thread_start);
+    }
+}
+
+DetectExecutor::~DetectExecutor() {
+    // 停止接收新任务，执行完已排队的任务后退出
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        state_->stopping = true;
+    }
+    state_->cv.notify_all();
+    for (auto& worker : workers_) {
+        // 在工作线程上析构（如协程恢复后销毁了所属的 AsyncDetector）时不能等待自己
+        if (worker.get_id() == std::this_thread::get_id()) {
+            worker.detach();
+        } else {
+            worker.join();
+        }
+    }
+}
+
+bool DetectExecutor::submit(std::function<void()> task) {
+    // 入队后任务可能立即在其他线程上析构执行器，之后只能访问局部持有的状态
+    std::shared_ptr<State> state = state_;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (state->stopping || state->tasks.size() >= max_pending_) {
+            return false;
+        }
+        state->tasks.push_back(std::move(task));
+    }
+    state->cv.notify_one();
+    return true;
+}
+
+void DetectExecutor::post(std::function<void()> completion) {
+    std::shared_ptr<State> state = state_;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->completions.push_back(std::move(completion));
+    }
+    state->cv.notify_one();
+}
+
+size_t DetectExecutor::get_num_threads() const {
+    return workers_.size();
+}
+
+size_t DetectExecutor::get_pending() const {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->tasks.size() + state_->completions.size();
+}
+
+void DetectExecutor::worker_loop(std::shared_ptr<State> state, std::function<void()> on_thread_start) {
+    if (on_thread_start) {
+        on_thread_start();
+    }
+
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(state->mutex);
+            state->cv.wait(lock, [&state]() {
+                return state->stopping || !state->tasks.empty() || !state->completions.empty();
+            });
+
+            // 完成回调优先，尽快释放已占用的帧
+            if (!state->completions.empty()) {
+                task = std::move(state->completions.front());
+                state->completions.pop_front();
+            } else if (!state->tasks.empty()) {
+                task = std::move(state->tasks.front());
+                state->tasks.pop_front();
+            } else {
+                return;
+            }
+        }
+
+        try {
+            task();
+        } catch (const std::exception& e) {
+            std::cerr << "检测任务异常: " << e.what() << std::endl;
+        } catch (...) {
+            std::cerr << "检测任务异常: 未知异常" << std::endl;
+        }
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef DETECT_EXECUTOR_H
+#define DETECT_EXECUTOR_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 检测任务执行器 - 固定数量的工作线程 + 有界任务队列
+// 工作线程数即同时执行预处理/推理/后处理的最大帧数，避免核心超额订阅
+class DetectExecutor {
+public:
+    // on_thread_start 在每个工作线程开始取任务前调用一次（如绑定 CPU 和内存策略）
+    DetectExecutor(size_t num_threads, size_t max_pending, std::function<void()> on_thread_start = nullptr);
+    // 执行完已排队的任务后退出；允许在工作线程的任务中析构（该线程在任务返回后自行退出）
+    ~DetectExecutor();
+
+    // 禁用拷贝构造和赋值
+    DetectExecutor(const DetectExecutor&) = delete;
+    DetectExecutor& operator=(const DetectExecutor&) = delete;
+
+    // 提交新任务，队列已满或已停止时返回 false
+    bool submit(std::function<void()> task);
+
+    // 提交完成回调（如 RunAsync 完成后的后处理），不受队列上限限制且优先执行
+    void post(std::function<void()> completion);
+
+    size_t get_num_threads() const;
+    size_t get_pending() const;
+
+private:
+    // 队列状态由工作线程共同持有，执行器在工作线程上析构后该线程仍可安全退出
+    struct State {
+        bool stopping = false;
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<std::function<void()>> tasks;
+        std::deque<std::function<void()>> completions;
+    };
+
+    static void worker_loop(std::shared_ptr<State> state, std::function<void()> on_thread_start);
+
+    size_t max_pending_;
+    std::shared_ptr<State> state_;
+    std::vector<std::thread> workers_;
+};
+
+#endif // DETECT_EXECUTOR_H
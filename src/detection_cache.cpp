@@ -0,0 +1,381 @@
+#include "detection_cache.h"
+#include <xxhash.h>
+#include <algorithm>
+#include <bitset>
+#include <iostream>
+#include <limits>
+
+DetectionCache::DetectionCache(const CacheConfig& config) : config_(config) {
+    if (config_.num_shards == 0) {
+        config_.num_shards = 1;
+    }
+
+    max_entries_per_shard_ = std::max<size_t>(1, config_.max_entries / config_.num_shards);
+    memory_budget_per_shard_ = std::max<size_t>(1, config_.memory_budget_bytes / config_.num_shards);
+
+    shards_.reserve(config_.num_shards);
+    for (size_t i = 0; i < config_.num_shards; ++i) {
+        shards_.push_back(std::make_unique<Shard>());
+    }
+
+    num_bands_ = static_cast<size_t>(std::min(64, std::max(0, config_.max_hamming_distance) + 1));
+    if (config_.enable_perceptual) {
+        index_shards_.reserve(config_.num_shards);
+        for (size_t i = 0; i < config_.num_shards; ++i) {
+            index_shards_.push_back(std::make_unique<IndexShard>());
+        }
+    }
+}
+
+uint64_t DetectionCache::compute_content_hash(const cv::Mat& image) {
+    if (image.empty()) {
+        return 0;
+    }
+
+    // 尺寸和类型作为种子，避免不同形状但字节相同的图像冲突
+    uint64_t seed = (uint64_t(image.rows) << 40) ^ (uint64_t(image.cols) << 16) ^ uint64_t(image.type());
+    size_t row_bytes = image.cols * image.elemSize();
+
+    if (image.isContinuous()) {
+        return XXH3_64bits_withSeed(image.data, row_bytes * image.rows, seed);
+    }
+
+    // 非连续内存（ROI 等）按行累积哈希
+    XXH3_state_t* state = XXH3_createState();
+    XXH3_64bits_reset_withSeed(state, seed);
+    for (int r = 0; r < image.rows; ++r) {
+        XXH3_64bits_update(state, image.ptr(r), row_bytes);
+    }
+    uint64_t hash = XXH3_64bits_digest(state);
+    XXH3_freeState(state);
+    return hash;
+}
+
+uint64_t DetectionCache::compute_perceptual_hash(const cv::Mat& image) {
+    if (image.empty()) {
+        return 0;
+    }
+
+    // dHash: 缩放为 9x8 灰度图，比较相邻像素亮度
+    cv::Mat gray, small;
+    if (image.channels() == 3) {
+        cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+    } else if (image.channels() == 4) {
+        cv::cvtColor(image, gray, cv::COLOR_BGRA2GRAY);
+    } else {
+        gray = image;
+    }
+    cv::resize(gray, small, cv::Size(9, 8), 0, 0, cv::INTER_AREA);
+
+    uint64_t hash = 0;
+    for (int r = 0; r < 8; ++r) {
+        const uchar* row = small.ptr<uchar>(r);
+        for (int c = 0; c < 8; ++c) {
+            hash = (hash << 1) | (row[c] > row[c + 1] ? 1 : 0);
+        }
+    }
+
+    // 保证启用感知哈希时不为 0（0 表示未启用）
+    return hash == 0 ? 1 : hash;
+}
+
+uint64_t DetectionCache::compute_model_hash(const std::string& model_id, const cv::Size& input_size,
+                                            float candidate_floor) {
+    std::string fingerprint = model_id + "|" + std::to_string(input_size.width) + "x" +
+                              std::to_string(input_size.height) + "|" + std::to_string(candidate_floor);
+    return XXH3_64bits(fingerprint.data(), fingerprint.size());
+}
+
+bool DetectionCache::lookup(const CacheKey& key, const cv::Size& image_size,
+                            std::vector<Detection>& candidates) {
+    uint64_t id = entry_id(key);
+    Shard& shard = shard_for(id);
+
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.entries.find(id);
+        if (it != shard.entries.end() && it->second.key.content_hash == key.content_hash &&
+            it->second.key.model_hash == key.model_hash) {
+            if (is_expired(it->second, Clock::now())) {
+                erase_locked(shard, it);
+                shard.stats.expirations++;
+            } else {
+                shard.lru.splice(shard.lru.begin(), shard.lru, it->second.lru_it);
+                copy_scaled(it->second, image_size, candidates);
+                shard.stats.exact_hits++;
+                return true;
+            }
+        }
+    }
+
+    if (!index_shards_.empty() && key.perceptual_hash != 0 &&
+        lookup_near(key, image_size, candidates)) {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.stats.misses++;
+    return false;
+}
+
+bool DetectionCache::lookup_near(const CacheKey& key, const cv::Size& image_size,
+                                 std::vector<Detection>& candidates) {
+    // 只检查与查询哈希至少有一个位段相同的条目，每个位段锁一个索引分片
+    uint64_t best_id = 0;
+    int best_distance = std::numeric_limits<int>::max();
+
+    for (size_t band = 0; band < num_bands_; ++band) {
+        uint64_t bucket_key = band_key(key.perceptual_hash, key.model_hash, band);
+        IndexShard& index = index_shard_for(bucket_key);
+        std::lock_guard<std::mutex> lock(index.mutex);
+
+        auto bucket = index.buckets.find(bucket_key);
+        if (bucket == index.buckets.end()) continue;
+        for (const auto& item : bucket->second) {
+            if (item.model_hash != key.model_hash) continue;
+
+            int distance = static_cast<int>(std::bitset<64>(item.perceptual_hash ^ key.perceptual_hash).count());
+            if (distance <= config_.max_hamming_distance && distance < best_distance) {
+                best_distance = distance;
+                best_id = item.entry_id;
+            }
+        }
+    }
+
+    if (best_distance == std::numeric_limits<int>::max()) {
+        return false;
+    }
+
+    // 释放索引锁后条目可能已被其他线程淘汰，重新查找
+    Shard& best_shard = shard_for(best_id);
+    std::lock_guard<std::mutex> lock(best_shard.mutex);
+    auto it = best_shard.entries.find(best_id);
+    if (it == best_shard.entries.end()) {
+        return false;
+    }
+    if (is_expired(it->second, Clock::now())) {
+        erase_locked(best_shard, it);
+        best_shard.stats.expirations++;
+        return false;
+    }
+
+    best_shard.lru.splice(best_shard.lru.begin(), best_shard.lru, it->second.lru_it);
+    copy_scaled(it->second, image_size, candidates);
+    best_shard.stats.near_hits++;
+    return true;
+}
+
+void DetectionCache::insert(const CacheKey& key, const cv::Size& image_size,
+                            const std::vector<Detection>& candidates) {
+    uint64_t id = entry_id(key);
+    Shard& shard = shard_for(id);
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto existing = shard.entries.find(id);
+    if (existing != shard.entries.end()) {
+        erase_locked(shard, existing);
+    }
+
+    Entry entry;
+    entry.key = key;
+    entry.image_size = image_size;
+    entry.candidates = candidates;
+    entry.inserted_at = Clock::now();
+    // 估算内存：条目本身 + 候选框 + 哈希表和 LRU 链表节点开销
+    entry.memory_bytes = sizeof(Entry) + candidates.size() * sizeof(Detection) + 4 * sizeof(void*);
+
+    // 单个条目超过分片预算时不缓存
+    if (entry.memory_bytes > memory_budget_per_shard_) {
+        return;
+    }
+
+    shard.lru.push_front(id);
+    entry.lru_it = shard.lru.begin();
+    shard.memory_bytes += entry.memory_bytes;
+    shard.entries.emplace(id, std::move(entry));
+    shard.stats.insertions++;
+    index_add(key, id);
+
+    evict_locked(shard);
+}
+
+void DetectionCache::clear() {
+    for (auto& shard_ptr : shards_) {
+        std::lock_guard<std::mutex> lock(shard_ptr->mutex);
+        shard_ptr->entries.clear();
+        shard_ptr->lru.clear();
+        shard_ptr->memory_bytes = 0;
+    }
+    for (auto& index_ptr : index_shards_) {
+        std::lock_guard<std::mutex> lock(index_ptr->mutex);
+        index_ptr->buckets.clear();
+    }
+}
+
+CacheStats DetectionCache::get_stats() const {
+    CacheStats total;
+    for (const auto& shard_ptr : shards_) {
+        std::lock_guard<std::mutex> lock(shard_ptr->mutex);
+        total.exact_hits += shard_ptr->stats.exact_hits;
+        total.near_hits += shard_ptr->stats.near_hits;
+        total.misses += shard_ptr->stats.misses;
+        total.insertions += shard_ptr->stats.insertions;
+        total.evictions += shard_ptr->stats.evictions;
+        total.expirations += shard_ptr->stats.expirations;
+        total.entries += shard_ptr->entries.size();
+        total.memory_bytes += shard_ptr->memory_bytes;
+    }
+    return total;
+}
+
+const CacheConfig& DetectionCache::get_config() const {
+    return config_;
+}
+
+uint64_t DetectionCache::entry_id(const CacheKey& key) {
+    // 精确匹配只依赖内容哈希和模型指纹，感知哈希仅用于近似查找
+    return key.content_hash ^ (key.model_hash * 0x9E3779B97F4A7C15ULL);
+}
+
+DetectionCache::Shard& DetectionCache::shard_for(uint64_t id) {
+    return *shards_[((id >> 32) ^ id) % shards_.size()];
+}
+
+bool DetectionCache::is_expired(const Entry& entry, Clock::time_point now) const {
+    return config_.ttl.count() > 0 && now - entry.inserted_at > config_.ttl;
+}
+
+void DetectionCache::erase_locked(Shard& shard, std::unordered_map<uint64_t, Entry>::iterator it) {
+    index_remove(it->second.key, it->first);
+    shard.memory_bytes -= it->second.memory_bytes;
+    shard.lru.erase(it->second.lru_it);
+    shard.entries.erase(it);
+}
+
+void DetectionCache::evict_locked(Shard& shard) {
+    // 先清理 LRU 尾部的过期条目，再按条目数和内存预算淘汰最久未使用的条目
+    Clock::time_point now = Clock::now();
+    while (!shard.lru.empty()) {
+        auto it = shard.entries.find(shard.lru.back());
+        if (!is_expired(it->second, now)) break;
+        erase_locked(shard, it);
+        shard.stats.expirations++;
+    }
+
+    while (!shard.lru.empty() &&
+           (shard.entries.size() > max_entries_per_shard_ || shard.memory_bytes > memory_budget_per_shard_)) {
+        erase_locked(shard, shard.entries.find(shard.lru.back()));
+        shard.stats.evictions++;
+    }
+}
+
+uint64_t DetectionCache::band_key(uint64_t perceptual_hash, uint64_t model_hash, size_t band) const {
+    // 第 band 个位段覆盖 [64*band/n, 64*(band+1)/n) 位
+    size_t begin = 64 * band / num_bands_;
+    size_t end = 64 * (band + 1) / num_bands_;
+    uint64_t mask = (end - begin == 64) ? ~0ULL : ((1ULL << (end - begin)) - 1) << begin;
+    uint64_t bits[3] = {perceptual_hash & mask, model_hash, band};
+    return XXH3_64bits(bits, sizeof(bits));
+}
+
+DetectionCache::IndexShard& DetectionCache::index_shard_for(uint64_t key) {
+    return *index_shards_[((key >> 32) ^ key) % index_shards_.size()];
+}
+
+void DetectionCache::index_add(const CacheKey& key, uint64_t id) {
+    if (index_shards_.empty() || key.perceptual_hash == 0) {
+        return;
+    }
+    for (size_t band = 0; band < num_bands_; ++band) {
+        uint64_t bucket_key = band_key(key.perceptual_hash, key.model_hash, band);
+        IndexShard& index = index_shard_for(bucket_key);
+        std::lock_guard<std::mutex> lock(index.mutex);
+        index.buckets[bucket_key].push_back({id, key.perceptual_hash, key.model_hash});
+    }
+}
+
+void DetectionCache::index_remove(const CacheKey& key, uint64_t id) {
+    if (index_shards_.empty() || key.perceptual_hash == 0) {
+        return;
+    }
+    for (size_t band = 0; band < num_bands_; ++band) {
+        uint64_t bucket_key = band_key(key.perceptual_hash, key.model_hash, band);
+        IndexShard& index = index_shard_for(bucket_key);
+        std::lock_guard<std::mutex> lock(index.mutex);
+
+        auto bucket = index.buckets.find(bucket_key);
+        if (bucket == index.buckets.end()) continue;
+        auto& items = bucket->second;
+        items.erase(std::remove_if(items.begin(), items.end(),
+                                   [id](const IndexItem& item) { return item.entry_id == id; }),
+                    items.end());
+        if (items.empty()) {
+            index.buckets.erase(bucket);
+        }
+    }
+}
+
+void DetectionCache::copy_scaled(const Entry& entry, const cv::Size& image_size,
+                                 std::vector<Detection>& candidates) {
+    candidates = entry.candidates;
+    if (image_size == entry.image_size || entry.image_size.empty() || image_size.empty()) {
+        return;
+    }
+
+    // 近似重复图像（如缩略图）尺寸不同，将候选框缩放到查询图像坐标
+    float sx = float(image_size.width) / entry.image_size.width;
+    float sy = float(image_size.height) / entry.image_size.height;
+    for (auto& det : candidates) {
+        det.box = cv::Rect(int(det.box.x * sx), int(det.box.y * sy),
+                           int(det.box.width * sx), int(det.box.height * sy));
+    }
+}
+
+CachedDetector::CachedDetector(YOLOv5Detector& detector, DetectionCache& cache, const std::string& model_id)
+    : detector_(detector), cache_(cache) {
+    model_hash_ = DetectionCache::compute_model_hash(model_id.empty() ? detector.get_model_path() : model_id,
+                                                     detector.get_input_size(),
+                                                     cache.get_config().candidate_floor);
+}
+
+std::vector<Detection> CachedDetector::detect(const cv::Mat& image) {
+    if (image.empty()) {
+        std::cerr << "错误: 输入图像为空" << std::endl;
+        return {};
+    }
+
+    // 置信度阈值低于缓存下限时，缓存中的候选框不完整，直接走完整流程
+    float candidate_floor = cache_.get_config().candidate_floor;
+    if (detector_.get_confidence_threshold() < candidate_floor) {
+        return detector_.detect(image);
+    }
+
+    CacheKey key;
+    key.content_hash = DetectionCache::compute_content_hash(image);
+    key.model_hash = model_hash_;
+    if (cache_.get_config().enable_perceptual) {
+        key.perceptual_hash = DetectionCache::compute_perceptual_hash(image);
+    }
+
+    std::vector<Detection> candidates;
+    if (cache_.lookup(key, image.size(), candidates)) {
+        return detector_.select_detections(candidates);
+    }
+
+    // 未命中：经检测器入口执行预处理和推理（应用线程放置），缓存 NMS 之前的候选框
+    if (!detector_.detect_candidates(image, candidate_floor, candidates)) {
+        return {};
+    }
+    cache_.insert(key, image.size(), candidates);
+
+    return detector_.select_detections(candidates);
+}
+
+YOLOv5Detector& CachedDetector::get_detector() {
+    return detector_;
+}
+
+DetectionCache& CachedDetector::get_cache() {
+    return cache_;
+}
@@ -0,0 +1,157 @@
+#ifndef DETECTION_CACHE_H
+#define DETECTION_CACHE_H
+
+#include "yolov5.h"
+#include <opencv2/opencv.hpp>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 缓存键 - 图像内容指纹 + 模型指纹
+struct CacheKey {
+    uint64_t content_hash = 0;     // 原始像素字节的 xxHash (XXH3 64位)
+    uint64_t perceptual_hash = 0;  // 64位差值哈希 (dHash)，用于近似重复图像，未启用时为 0
+    uint64_t model_hash = 0;       // 模型ID + 输入尺寸 + 候选框得分下限
+
+    bool operator==(const CacheKey& other) const {
+        return content_hash == other.content_hash &&
+               perceptual_hash == other.perceptual_hash &&
+               model_hash == other.model_hash;
+    }
+};
+
+// 缓存配置
+struct CacheConfig {
+    size_t num_shards = 16;                            // 分片数量，降低多线程锁竞争
+    size_t max_entries = 4096;                         // 最大条目数（所有分片合计）
+    size_t memory_budget_bytes = 64 * 1024 * 1024;     // 内存预算（所有分片合计）
+    std::chrono::milliseconds ttl{60000};              // 条目存活时间，0 表示不过期
+    bool enable_perceptual = false;                    // 是否启用感知哈希查找近似重复图像
+    int max_hamming_distance = 4;                      // 近似重复判定的最大汉明距离
+    float candidate_floor = 0.25f;                     // 缓存候选框的最低得分，低于该值的阈值会绕过缓存
+};
+
+// 缓存统计指标
+struct CacheStats {
+    uint64_t exact_hits = 0;    // 内容哈希命中
+    uint64_t near_hits = 0;     // 感知哈希命中（近似重复）
+    uint64_t misses = 0;        // 未命中
+    uint64_t insertions = 0;    // 插入次数
+    uint64_t evictions = 0;     // LRU / 内存预算淘汰次数
+    uint64_t expirations = 0;   // TTL 过期次数
+    size_t entries = 0;         // 当前条目数
+    size_t memory_bytes = 0;    // 当前估算内存占用
+
+    double hit_rate() const {
+        uint64_t total = exact_hits + near_hits + misses;
+        return total == 0 ? 0.0 : double(exact_hits + near_hits) / total;
+    }
+};
+
+// 检测结果缓存 - 分片 LRU + TTL + 内存预算，缓存 NMS 之前的候选框
+class DetectionCache {
+public:
+    explicit DetectionCache(const CacheConfig& config = CacheConfig());
+
+    // 禁用拷贝构造和赋值
+    DetectionCache(const DetectionCache&) = delete;
+    DetectionCache& operator=(const DetectionCache&) = delete;
+
+    // 哈希计算
+    static uint64_t compute_content_hash(const cv::Mat& image);
+    static uint64_t compute_perceptual_hash(const cv::Mat& image);
+    static uint64_t compute_model_hash(const std::string& model_id, const cv::Size& input_size,
+                                       float candidate_floor);
+
+    // 查找候选框，命中时候选框坐标会缩放到 image_size（近似重复图像尺寸可能不同）
+    bool lookup(const CacheKey& key, const cv::Size& image_size, std::vector<Detection>& candidates);
+
+    // 插入候选框，image_size 为候选框坐标所在的原图尺寸
+    void insert(const CacheKey& key, const cv::Size& image_size, const std::vector<Detection>& candidates);
+
+    void clear();
+    CacheStats get_stats() const;
+    const CacheConfig& get_config() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        CacheKey key;
+        cv::Size image_size;
+        std::vector<Detection> candidates;
+        Clock::time_point inserted_at;
+        size_t memory_bytes = 0;
+        std::list<uint64_t>::iterator lru_it;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<uint64_t, Entry> entries;
+        std::list<uint64_t> lru;   // 头部为最近使用
+        size_t memory_bytes = 0;
+        CacheStats stats;
+    };
+
+    // 感知哈希索引（多索引哈希）：64 位哈希切成 max_hamming_distance + 1 个位段，
+    // 汉明距离不超过该值的两个哈希至少有一个位段完全相同，因此只需查找各位段的桶
+    struct IndexItem {
+        uint64_t entry_id;
+        uint64_t perceptual_hash;
+        uint64_t model_hash;
+    };
+
+    struct IndexShard {
+        mutable std::mutex mutex;
+        std::unordered_map<uint64_t, std::vector<IndexItem>> buckets;
+    };
+
+    // 内部辅助函数（调用方需持有分片锁）
+    static uint64_t entry_id(const CacheKey& key);
+    Shard& shard_for(uint64_t id);
+    bool is_expired(const Entry& entry, Clock::time_point now) const;
+    void erase_locked(Shard& shard, std::unordered_map<uint64_t, Entry>::iterator it);
+    void evict_locked(Shard& shard);
+    static void copy_scaled(const Entry& entry, const cv::Size& image_size,
+                            std::vector<Detection>& candidates);
+    bool lookup_near(const CacheKey& key, const cv::Size& image_size,
+                     std::vector<Detection>& candidates);
+
+    // 感知哈希索引维护（插入和删除时调用方持有条目所在分片的锁，锁顺序为 分片 -> 索引分片）
+    uint64_t band_key(uint64_t perceptual_hash, uint64_t model_hash, size_t band) const;
+    IndexShard& index_shard_for(uint64_t key);
+    void index_add(const CacheKey& key, uint64_t id);
+    void index_remove(const CacheKey& key, uint64_t id);
+
+    CacheConfig config_;
+    size_t max_entries_per_shard_;
+    size_t memory_budget_per_shard_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    size_t num_bands_;
+    std::vector<std::unique_ptr<IndexShard>> index_shards_;
+};
+
+// 带缓存的检测器 - 在 YOLOv5Detector::detect 之前查询缓存
+class CachedDetector {
+public:
+    // model_id 为空时使用检测器的模型路径
+    CachedDetector(YOLOv5Detector& detector, DetectionCache& cache, const std::string& model_id = "");
+
+    // 完整检测流程：命中缓存时只重新执行阈值过滤和 NMS
+    std::vector<Detection> detect(const cv::Mat& image);
+
+    YOLOv5Detector& get_detector();
+    DetectionCache& get_cache();
+
+private:
+    YOLOv5Detector& detector_;
+    DetectionCache& cache_;
+    uint64_t model_hash_;
+};
+
+#endif // DETECTION_CACHE_H
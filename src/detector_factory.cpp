@@ -0,0 +1,50 @@
+#include "detector_factory.h"
+
+DetectorFactory::DetectorFactory(bool share_weights, bool share_allocator)
+    : share_weights_(share_weights), share_allocator_(share_allocator) {
+    if (share_weights_) {
+        resources_ = std::make_shared<SessionResources>(share_allocator_);
+        share_allocator_ = resources_->is_allocator_shared();
+    }
+}
+
+std::unique_ptr<YOLOv5Detector> DetectorFactory::create(const std::string& model_path,
+                                                        float confidence_threshold,
+                                                        float nms_threshold,
+                                                        const ThreadPlacement& placement) {
+    std::shared_ptr<SessionResources> resources = placement.is_pinned()
+        ? get_node_resources(placement.numa_node)
+        : resources_;
+    return std::make_unique<YOLOv5Detector>(model_path, resources, confidence_threshold, nms_threshold,
+                                            placement);
+}
+
+bool DetectorFactory::is_sharing_weights() const {
+    return share_weights_;
+}
+
+bool DetectorFactory::is_sharing_allocator() const {
+    return share_weights_ && share_allocator_;
+}
+
+std::shared_ptr<SessionResources> DetectorFactory::get_resources() const {
+    return resources_;
+}
+
+std::shared_ptr<SessionResources> DetectorFactory::get_node_resources(int numa_node) {
+    if (!share_weights_) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(node_resources_mutex_);
+    auto it = node_resources_.find(numa_node);
+    if (it != node_resources_.end()) {
+        return it->second;
+    }
+
+    // 每个节点一份预打包权重；Env 注册的分配器是进程级的，跨节点共享会让激活内存落在其他节点，
+    // 因此节点资源始终使用会话自己的分配器（与 share_allocator_ 无关）
+    auto resources = std::make_shared<SessionResources>(false);
+    node_resources_[numa_node] = resources;
+    return resources;
+}
@@ -0,0 +1,39 @@
+#ifndef DETECTOR_FACTORY_H
+#define DETECTOR_FACTORY_H
+
+#include "yolov5.h"
+#include "session_resources.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// 检测器工厂 - 每路视频流一个检测器时，通过共享资源避免权重和预打包缓冲区按实例线性增长
+// create() 可在多个线程中并发调用
+class DetectorFactory {
+public:
+    // share_weights 为 false 时退化为每个检测器独立创建会话（用于对比测试）
+    // share_allocator 只作用于未绑定的检测器：绑定到 NUMA 节点的检测器始终使用会话自己的 Arena，
+    // 避免激活内存落在其他节点的共享内存池中
+    explicit DetectorFactory(bool share_weights = true, bool share_allocator = true);
+
+    // 绑定到 NUMA 节点的检测器使用该节点专属的预打包权重，避免跨节点访问权重
+    std::unique_ptr<YOLOv5Detector> create(const std::string& model_path,
+                                           float confidence_threshold = 0.5f,
+                                           float nms_threshold = 0.4f,
+                                           const ThreadPlacement& placement = ThreadPlacement());
+
+    bool is_sharing_weights() const;
+    bool is_sharing_allocator() const;
+    std::shared_ptr<SessionResources> get_resources() const;
+    std::shared_ptr<SessionResources> get_node_resources(int numa_node);
+
+private:
+    bool share_weights_;
+    bool share_allocator_;
+    std::shared_ptr<SessionResources> resources_;
+    std::mutex node_resources_mutex_;
+    std::map<int, std::shared_ptr<SessionResources>> node_resources_;
+};
+
+#endif // DETECTOR_FACTORY_H
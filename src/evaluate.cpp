@@ -0,0 +1,354 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <numeric>
+#include <algorithm>
+#include <opencv2/opencv.hpp>
+#include <fmt/format.h>
+#include <fmt/color.h>
+#include "coco_evaluator.h"
+#include "detector_factory.h"
+#include "cascade_detector.h"
+#include <functional>
+
+// 单组评估配置
+struct EvalConfig {
+    std::string model_path;
+    std::string cascade_model_path;     // 非空时为级联模式：model_path 为第一级，该模型为第二级
+    float confidence_threshold = 0.001f;
+    float nms_threshold = 0.45f;
+};
+
+// 单组配置的评估结果（精度 + 速度）
+struct EvalRecord {
+    EvalConfig config;
+    EvaluationResult accuracy;
+    double latency_mean_ms = 0.0;
+    double latency_p95_ms = 0.0;
+    double throughput_fps = 0.0;
+    int num_images = 0;
+    double escalation_rate = -1.0;      // 级联模式的升级率，非级联为 -1
+    bool pareto_optimal = false;
+};
+
+void print_usage(const char* program) {
+    fmt::print("用法: {} --images <图像目录> --annotations <COCO标注.json> --model <模型.onnx> [选项]\n", program);
+    fmt::print("选项:\n");
+    fmt::print("  --model <路径>        模型路径，可重复指定以比较多个模型（如 FP16/FP32/INT8、不同输入尺寸）\n");
+    fmt::print("  --conf <列表>         置信度阈值列表，逗号分隔（默认 0.001）\n");
+    fmt::print("  --nms <列表>          NMS 阈值列表，逗号分隔（默认 0.45）\n");
+    fmt::print("  --cascade <小,大>      级联模式：小模型全图检测，不确定区域交给大模型，可重复指定\n");
+    fmt::print("  --band <低,高>        级联不确定区间（默认 0.25,0.6）\n");
+    fmt::print("  --budget <N>          级联每帧最多升级的区域数（默认 4）\n");
+    fmt::print("  --max-images <N>      最多评估 N 张图像（默认全部）\n");
+    fmt::print("  --per-class           输出每个类别的 AP\n");
+    fmt::print("  --csv <路径>          将 Pareto 表格写入 CSV 文件\n");
+}
+
+std::vector<float> parse_float_list(const std::string& text) {
+    std::vector<float> values;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) values.push_back(std::stof(item));
+    }
+    return values;
+}
+
+std::string model_name(const std::string& model_path) {
+    size_t slash = model_path.find_last_of("/\\");
+    return slash == std::string::npos ? model_path : model_path.substr(slash + 1);
+}
+
+std::string config_name(const EvalConfig& config) {
+    if (config.cascade_model_path.empty()) {
+        return model_name(config.model_path);
+    }
+    return model_name(config.model_path) + "+" + model_name(config.cascade_model_path);
+}
+
+// 在数据集上运行一组配置，同时记录检测结果和单帧延迟
+bool run_config(DetectorFactory& factory, CocoEvaluator& evaluator, const std::string& images_dir,
+                int max_images, const CascadeConfig& cascade_template, EvalRecord& record) {
+    std::unique_ptr<YOLOv5Detector> detector;
+    std::unique_ptr<CascadeDetector> cascade;
+    std::function<std::vector<Detection>(const cv::Mat&)> detect;
+
+    if (record.config.cascade_model_path.empty()) {
+        detector = factory.create(record.config.model_path, record.config.confidence_threshold,
+                                  record.config.nms_threshold);
+        if (!detector->is_model_loaded()) {
+            return false;
+        }
+        detect = [&](const cv::Mat& image) { return detector->detect(image); };
+    } else {
+        CascadeConfig cascade_config = cascade_template;
+        cascade_config.small_model_path = record.config.model_path;
+        cascade_config.large_model_path = record.config.cascade_model_path;
+        cascade_config.confidence_threshold = record.config.confidence_threshold;
+        cascade_config.nms_threshold = record.config.nms_threshold;
+        cascade = std::make_unique<CascadeDetector>(cascade_config, factory);
+        if (!cascade->is_ready()) {
+            return false;
+        }
+        detect = [&](const cv::Mat& image) { return cascade->detect(image); };
+    }
+
+    evaluator.reset_detections();
+    const auto& images = evaluator.get_images();
+    size_t count = max_images > 0 ? std::min(images.size(), size_t(max_images)) : images.size();
+
+    std::vector<double> latencies;
+    latencies.reserve(count);
+    bool warmed_up = false;
+
+    for (size_t i = 0; i < count; ++i) {
+        // 图像读取不计入延迟
+        cv::Mat image = cv::imread(images_dir + "/" + images[i].file_name);
+        if (image.empty()) {
+            fmt::print(fmt::fg(fmt::color::yellow), "⚠️  跳过无法读取的图像: {}\n", images[i].file_name);
+            continue;
+        }
+
+        // 预热一次，避免首帧初始化开销影响延迟统计
+        if (!warmed_up) {
+            detect(image);
+            if (cascade) {
+                cascade->reset_stats();
+            }
+            warmed_up = true;
+        }
+
+        auto start = std::chrono::high_resolution_clock::now();
+        std::vector<Detection> detections = detect(image);
+        auto end = std::chrono::high_resolution_clock::now();
+        latencies.push_back(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0);
+
+        evaluator.add_detections(images[i].id, detections);
+
+        if ((i + 1) % 100 == 0) {
+            fmt::print("  ✓ 完成 {}/{} 张图像\n", i + 1, count);
+        }
+    }
+
+    if (latencies.empty()) {
+        return false;
+    }
+
+    double total_ms = std::accumulate(latencies.begin(), latencies.end(), 0.0);
+    std::sort(latencies.begin(), latencies.end());
+
+    record.num_images = static_cast<int>(latencies.size());
+    record.latency_mean_ms = total_ms / latencies.size();
+    record.latency_p95_ms = latencies[static_cast<size_t>(latencies.size() * 0.95)];
+    record.throughput_fps = 1000.0 * latencies.size() / total_ms;
+    record.accuracy = evaluator.evaluate();
+    if (cascade) {
+        record.escalation_rate = cascade->get_stats().escalation_rate();
+    }
+    return true;
+}
+
+// 标记 Pareto 最优配置：不存在另一组配置在 mAP@0.5:0.95 和吞吐量上同时不差且至少一项更好
+void mark_pareto(std::vector<EvalRecord>& records) {
+    for (auto& a : records) {
+        a.pareto_optimal = true;
+        for (const auto& b : records) {
+            if (&a == &b) continue;
+            bool no_worse = b.accuracy.map50_95 >= a.accuracy.map50_95 && b.throughput_fps >= a.throughput_fps;
+            bool better = b.accuracy.map50_95 > a.accuracy.map50_95 || b.throughput_fps > a.throughput_fps;
+            if (no_worse && better) {
+                a.pareto_optimal = false;
+                break;
+            }
+        }
+    }
+}
+
+void print_per_class(const EvalRecord& record) {
+    fmt::print(fmt::fg(fmt::color::green) | fmt::emphasis::bold,
+               "\n📋 每类 AP: {} (conf={:.3f}, nms={:.2f})\n",
+               config_name(record.config), record.config.confidence_threshold,
+               record.config.nms_threshold);
+    fmt::print("┌──────────────────┬──────────┬──────────┬────────────┐\n");
+    fmt::print("│ 类别             │ 标注数   │ AP@0.5   │ AP@.5:.95  │\n");
+    fmt::print("├──────────────────┼──────────┼──────────┼────────────┤\n");
+    for (const auto& class_ap : record.accuracy.per_class) {
+        fmt::print("│ {:<16} │ {:8} │ {:8.3f} │ {:10.3f} │\n",
+                   class_ap.class_name, class_ap.num_ground_truth, class_ap.ap50, class_ap.ap50_95);
+    }
+    fmt::print("└──────────────────┴──────────┴──────────┴────────────┘\n");
+}
+
+void print_pareto_table(const std::vector<EvalRecord>& records) {
+    fmt::print(fmt::fg(fmt::color::magenta) | fmt::emphasis::bold, "\n🎯 速度/精度 Pareto 表\n");
+    fmt::print("┌──────────────────────┬────────┬────────┬──────────┬────────────┬──────────┬──────────┬──────────┬────────┐\n");
+    fmt::print("│ 模型                 │ conf   │ nms    │ mAP@0.5  │ mAP@.5:.95 │ 平均(ms) │ P95(ms)  │ FPS      │ Pareto │\n");
+    fmt::print("├──────────────────────┼────────┼────────┼──────────┼────────────┼──────────┼──────────┼──────────┼────────┤\n");
+    for (const auto& r : records) {
+        fmt::print("│ {:<20} │ {:6.3f} │ {:6.2f} │ {:8.4f} │ {:10.4f} │ {:8.2f} │ {:8.2f} │ {:8.1f} │ {:<6} │\n",
+                   config_name(r.config).substr(0, 20), r.config.confidence_threshold,
+                   r.config.nms_threshold, r.accuracy.map50, r.accuracy.map50_95,
+                   r.latency_mean_ms, r.latency_p95_ms, r.throughput_fps, r.pareto_optimal ? "★" : "");
+    }
+    fmt::print("└──────────────────────┴────────┴────────┴──────────┴────────────┴──────────┴──────────┴──────────┴────────┘\n");
+}
+
+bool write_csv(const std::string& path, const std::vector<EvalRecord>& records) {
+    std::ofstream csv(path);
+    if (!csv.is_open()) {
+        return false;
+    }
+    csv << "model,cascade_model,conf,nms,images,map50,map50_95,latency_mean_ms,latency_p95_ms,fps,escalation_rate,pareto\n";
+    for (const auto& r : records) {
+        csv << fmt::format("{},{},{},{},{},{:.5f},{:.5f},{:.3f},{:.3f},{:.2f},{},{}\n",
+                           r.config.model_path, r.config.cascade_model_path,
+                           r.config.confidence_threshold, r.config.nms_threshold,
+                           r.num_images, r.accuracy.map50, r.accuracy.map50_95,
+                           r.latency_mean_ms, r.latency_p95_ms, r.throughput_fps,
+                           r.escalation_rate >= 0.0 ? fmt::format("{:.4f}", r.escalation_rate) : "",
+                           r.pareto_optimal ? 1 : 0);
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    fmt::print(fmt::fg(fmt::color::cyan) | fmt::emphasis::bold,
+               "📐 YOLOv5 速度/精度评估（COCO mAP）\n\n");
+
+    std::string images_dir;
+    std::string annotation_path;
+    std::string csv_path;
+    std::vector<std::string> model_paths;
+    std::vector<std::pair<std::string, std::string>> cascade_paths;
+    CascadeConfig cascade_template;
+    std::vector<float> confidence_thresholds = {0.001f};
+    std::vector<float> nms_thresholds = {0.45f};
+    int max_images = 0;
+    bool per_class = false;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            bool has_value = i + 1 < argc;
+            if (arg == "--images" && has_value) images_dir = argv[++i];
+            else if (arg == "--annotations" && has_value) annotation_path = argv[++i];
+            else if (arg == "--model" && has_value) model_paths.push_back(argv[++i]);
+            else if (arg == "--conf" && has_value) confidence_thresholds = parse_float_list(argv[++i]);
+            else if (arg == "--nms" && has_value) nms_thresholds = parse_float_list(argv[++i]);
+            else if (arg == "--cascade" && has_value) {
+                std::string pair = argv[++i];
+                size_t comma = pair.find(',');
+                if (comma == std::string::npos) {
+                    print_usage(argv[0]);
+                    return -1;
+                }
+                cascade_paths.emplace_back(pair.substr(0, comma), pair.substr(comma + 1));
+            }
+            else if (arg == "--band" && has_value) {
+                std::vector<float> band = parse_float_list(argv[++i]);
+                if (band.size() != 2) {
+                    print_usage(argv[0]);
+                    return -1;
+                }
+                cascade_template.uncertain_low = band[0];
+                cascade_template.uncertain_high = band[1];
+            }
+            else if (arg == "--budget" && has_value) cascade_template.max_crops_per_frame = std::stoul(argv[++i]);
+            else if (arg == "--max-images" && has_value) max_images = std::stoi(argv[++i]);
+            else if (arg == "--csv" && has_value) csv_path = argv[++i];
+            else if (arg == "--per-class") per_class = true;
+            else {
+                print_usage(argv[0]);
+                return -1;
+            }
+        }
+    } catch (const std::exception& e) {
+        fmt::print(fmt::fg(fmt::color::red), "❌ 参数错误: {}\n", e.what());
+        return -1;
+    }
+
+    if (images_dir.empty() || annotation_path.empty() || (model_paths.empty() && cascade_paths.empty()) ||
+        confidence_thresholds.empty() || nms_thresholds.empty()) {
+        print_usage(argv[0]);
+        return -1;
+    }
+
+    // 共享权重，同一模型的多组阈值配置只加载一份预打包权重
+    DetectorFactory factory;
+
+    // 模型类别名称（用于映射 COCO category_id）
+    std::vector<std::string> class_names;
+    {
+        YOLOv5Detector probe(model_paths.empty() ? cascade_paths.front().first : model_paths.front(),
+                             factory.get_resources());
+        for (int i = 0; probe.get_class_name(i) != "unknown"; ++i) {
+            class_names.push_back(probe.get_class_name(i));
+        }
+    }
+
+    CocoEvaluator evaluator;
+    if (!evaluator.load_annotations(annotation_path, class_names)) {
+        return -1;
+    }
+
+    // 单模型配置在前，级联配置在后
+    std::vector<EvalConfig> configs;
+    for (const auto& model_path : model_paths) {
+        configs.push_back({model_path, "", 0.0f, 0.0f});
+    }
+    for (const auto& cascade_path : cascade_paths) {
+        configs.push_back({cascade_path.first, cascade_path.second, 0.0f, 0.0f});
+    }
+
+    std::vector<EvalRecord> records;
+    for (const auto& base_config : configs) {
+        for (float conf : confidence_thresholds) {
+            for (float nms : nms_thresholds) {
+                EvalRecord record;
+                record.config = base_config;
+                record.config.confidence_threshold = conf;
+                record.config.nms_threshold = nms;
+
+                fmt::print(fmt::fg(fmt::color::yellow) | fmt::emphasis::bold,
+                           "\n⏱️  评估 {} (conf={:.3f}, nms={:.2f})\n", config_name(record.config), conf, nms);
+                if (!run_config(factory, evaluator, images_dir, max_images, cascade_template, record)) {
+                    fmt::print(fmt::fg(fmt::color::red), "❌ 评估失败: {}\n", config_name(record.config));
+                    continue;
+                }
+
+                fmt::print("  • mAP@0.5: {:.4f} | mAP@0.5:0.95: {:.4f} | 平均延迟: {:.2f} ms | FPS: {:.1f}\n",
+                           record.accuracy.map50, record.accuracy.map50_95,
+                           record.latency_mean_ms, record.throughput_fps);
+                if (record.escalation_rate >= 0.0) {
+                    fmt::print("  • 级联升级率: {:.1f}%\n", record.escalation_rate * 100);
+                }
+                if (per_class) {
+                    print_per_class(record);
+                }
+                records.push_back(record);
+            }
+        }
+    }
+
+    if (records.empty()) {
+        fmt::print(fmt::fg(fmt::color::red), "❌ 没有成功的评估结果\n");
+        return -1;
+    }
+
+    mark_pareto(records);
+    print_pareto_table(records);
+
+    if (!csv_path.empty()) {
+        if (write_csv(csv_path, records)) {
+            fmt::print(fmt::fg(fmt::color::green), "💾 结果已保存到: {}\n", csv_path);
+        } else {
+            fmt::print(fmt::fg(fmt::color::red), "❌ 无法写入 CSV: {}\n", csv_path);
+        }
+    }
+
+    return 0;
+}
@@ -7,6 +7,7 @@
 #include <numeric>
 #include <algorithm>
 #include "yolov5.h"
+#include "detection_cache.h"
 
 // 批量推理测试函数
 void benchmark_inference(YOLOv5Detector& detector, const cv::Mat& image, int iterations = 100) {
@@ -128,6 +129,58 @@ void benchmark_inference(YOLOv5Detector& detector, const cv::Mat& image, int ite
                pre_pct, inf_pct, post_pct);
 }
 
+// 结果缓存测试函数（重复帧 + 重新设定阈值）
+void benchmark_cache(YOLOv5Detector& detector, const cv::Mat& image, int iterations = 100) {
+    fmt::print(fmt::fg(fmt::color::cyan) | fmt::emphasis::bold,
+               "\n🗂️  开始结果缓存测试 ({}次重复帧)\n", iterations);
+    fmt::print("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n");
+
+    CacheConfig config;
+    config.enable_perceptual = true;
+    DetectionCache cache(config);
+    CachedDetector cached_detector(detector, cache);
+
+    float original_threshold = detector.get_confidence_threshold();
+    std::vector<double> frame_times;
+    frame_times.reserve(iterations);
+
+    for (int i = 0; i < iterations; ++i) {
+        // 每10帧调整一次置信度阈值，验证重新设定阈值时复用缓存的候选框
+        if (i % 10 == 0) {
+            detector.set_confidence_threshold(std::max(config.candidate_floor,
+                                                       original_threshold - 0.05f * (i / 10 % 3)));
+        }
+
+        auto start = std::chrono::high_resolution_clock::now();
+        std::vector<Detection> detections = cached_detector.detect(image);
+        auto end = std::chrono::high_resolution_clock::now();
+        frame_times.push_back(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0);
+    }
+
+    // 近似重复帧：缩略图
+    cv::Mat thumbnail;
+    cv::resize(image, thumbnail, cv::Size(image.cols / 2, image.rows / 2), 0, 0, cv::INTER_AREA);
+    std::vector<Detection> thumbnail_detections = cached_detector.detect(thumbnail);
+
+    detector.set_confidence_threshold(original_threshold);
+
+    CacheStats stats = cache.get_stats();
+    double first_frame = frame_times.front();
+    double cached_mean = frame_times.size() > 1
+        ? std::accumulate(frame_times.begin() + 1, frame_times.end(), 0.0) / (frame_times.size() - 1)
+        : 0.0;
+
+    fmt::print(fmt::fg(fmt::color::green) | fmt::emphasis::bold, "📊 缓存统计结果\n");
+    fmt::print("  • 首帧（未命中）耗时: {:.2f} ms\n", first_frame);
+    fmt::print("  • 重复帧平均耗时: {:.3f} ms\n", cached_mean);
+    fmt::print("  • 精确命中: {} | 近似命中: {} | 未命中: {}\n",
+               stats.exact_hits, stats.near_hits, stats.misses);
+    fmt::print("  • 命中率: {:.1f}%\n", stats.hit_rate() * 100);
+    fmt::print("  • 条目数: {} | 内存占用: {:.1f} KB | 淘汰: {} | 过期: {}\n",
+               stats.entries, stats.memory_bytes / 1024.0, stats.evictions, stats.expirations);
+    fmt::print("  • 缩略图检测到 {} 个目标\n", thumbnail_detections.size());
+}
+
 int main() {
     fmt::print(fmt::fg(fmt::color::cyan) | fmt::emphasis::bold,
                "🚀 YOLOv5 ONNX 推理性能测试\n\n");
@@ -212,6 +265,9 @@ int main() {
         // 5. 执行批量推理性能测试
         benchmark_inference(detector, image, 100);
 
+        // 5.1 结果缓存测试
+        benchmark_cache(detector, image, 100);
+
         // 6. 绘制结果并保存（使用预热的检测结果）
         auto start_draw = std::chrono::high_resolution_clock::now();
         cv::Mat result_image = detector.draw_detections(image, detections);
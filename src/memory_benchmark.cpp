@@ -0,0 +1,147 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include <fmt/format.h>
+#include <fmt/color.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "detector_factory.h"
+
+// 单次测量结果（单位 MB）
+struct MemorySample {
+    double baseline_mb = 0.0;      // 创建检测器之前
+    double loaded_mb = 0.0;        // 全部检测器加载完成后
+    double inference_mb = 0.0;     // 每个检测器完成一次推理后（Arena 已分配）
+    bool ok = false;
+};
+
+// 读取当前进程常驻内存（VmRSS）
+double read_rss_mb() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmRSS:", 0) == 0) {
+            std::istringstream iss(line.substr(6));
+            double kb = 0.0;
+            iss >> kb;
+            return kb / 1024.0;
+        }
+    }
+    return 0.0;
+}
+
+// 在子进程中创建 count 个检测器并测量内存，避免前一轮测试的内存残留影响结果
+MemorySample measure_in_child(const std::string& model_path, const cv::Mat& image,
+                              int count, bool share_weights) {
+    MemorySample sample;
+
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return sample;
+    }
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return sample;
+    }
+
+    if (pid == 0) {
+        close(fds[0]);
+
+        // 屏蔽检测器加载日志，保持表格输出整洁
+        int devnull = open("/dev/null", O_WRONLY);
+        if (devnull >= 0) {
+            dup2(devnull, STDOUT_FILENO);
+            close(devnull);
+        }
+
+        MemorySample child;
+        child.baseline_mb = read_rss_mb();
+
+        DetectorFactory factory(share_weights);
+        std::vector<std::unique_ptr<YOLOv5Detector>> detectors;
+        detectors.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            detectors.push_back(factory.create(model_path));
+        }
+        child.loaded_mb = read_rss_mb();
+
+        child.ok = true;
+        for (auto& detector : detectors) {
+            if (!detector->is_model_loaded()) {
+                child.ok = false;
+                break;
+            }
+            detector->detect(image);
+        }
+        child.inference_mb = read_rss_mb();
+
+        ssize_t written = write(fds[1], &child, sizeof(child));
+        close(fds[1]);
+        _exit(written == static_cast<ssize_t>(sizeof(child)) ? 0 : 1);
+    }
+
+    close(fds[1]);
+    ssize_t bytes = read(fds[0], &sample, sizeof(sample));
+    close(fds[0]);
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (bytes != static_cast<ssize_t>(sizeof(sample)) || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        sample.ok = false;
+    }
+    return sample;
+}
+
+int main(int argc, char** argv) {
+    fmt::print(fmt::fg(fmt::color::cyan) | fmt::emphasis::bold,
+               "🧮 YOLOv5 多实例内存测试（独立会话 vs 共享权重）\n\n");
+
+    // 模型和图片路径（可通过命令行参数覆盖）
+    std::string model_path = "/workspaces/YOLOv5-ONNXRuntime/assets/models/yolov5n.onnx";
+    std::string image_path = "/workspaces/YOLOv5-ONNXRuntime/assets/images/bus.jpg";
+    if (argc > 1) model_path = argv[1];
+    if (argc > 2) image_path = argv[2];
+
+    cv::Mat image = cv::imread(image_path);
+    if (image.empty()) {
+        fmt::print(fmt::fg(fmt::color::red), "❌ 错误: 无法加载图像 {}\n", image_path);
+        return -1;
+    }
+
+    const std::vector<int> instance_counts = {1, 8, 32, 64};
+
+    fmt::print("┌──────────┬──────────┬──────────────┬──────────────┬──────────────┐\n");
+    fmt::print("│ 模式     │ 实例数   │ 加载后 (MB)  │ 推理后 (MB)  │ 每实例 (MB)  │\n");
+    fmt::print("├──────────┼──────────┼──────────────┼──────────────┼──────────────┤\n");
+
+    for (bool share_weights : {false, true}) {
+        const char* mode = share_weights ? "共享权重" : "独立会话";
+        for (int count : instance_counts) {
+            MemorySample sample = measure_in_child(model_path, image, count, share_weights);
+            if (!sample.ok) {
+                fmt::print(fmt::fg(fmt::color::red), "│ {:<8} │ {:8} │ 测试失败\n", mode, count);
+                continue;
+            }
+
+            double per_instance = (sample.inference_mb - sample.baseline_mb) / count;
+            fmt::print("│ {:<8} │ {:8} │ {:12.1f} │ {:12.1f} │ {:12.2f} │\n",
+                       mode, count, sample.loaded_mb, sample.inference_mb, per_instance);
+        }
+        if (!share_weights) {
+            fmt::print("├──────────┼──────────┼──────────────┼──────────────┼──────────────┤\n");
+        }
+    }
+
+    fmt::print("└──────────┴──────────┴──────────────┴──────────────┴──────────────┘\n");
+    fmt::print("  • 独立会话: 每个检测器独立的 Env、权重副本和预打包缓冲区（改造前）\n");
+    fmt::print("  • 共享权重: 共享 Env、模型 initializer、PrepackedWeightsContainer 和 Env 分配器（改造后）\n");
+
+    return 0;
+}
@@ -0,0 +1,342 @@
+#include "onnx_initializers.h"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <set>
+
+namespace {
+
+// protobuf 线格式类型
+constexpr int kWireVarint = 0;
+constexpr int kWireFixed64 = 1;
+constexpr int kWireLengthDelimited = 2;
+constexpr int kWireFixed32 = 5;
+
+// TensorProto.DataType
+constexpr int32_t kTypeFloat = 1;
+constexpr int32_t kTypeString = 8;
+constexpr int32_t kTypeInt64 = 7;
+constexpr int32_t kTypeDouble = 11;
+constexpr int32_t kTypeUint32 = 12;
+constexpr int32_t kTypeUint64 = 13;
+
+// TensorProto.DataLocation
+constexpr int64_t kLocationExternal = 1;
+
+// 只读 protobuf 消息的最小解析器，不依赖 libprotobuf
+class ProtoReader {
+public:
+    ProtoReader(const uint8_t* data, size_t size) : pos_(data), end_(data + size) {}
+
+    bool done() const { return pos_ >= end_; }
+
+    bool read_varint(uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64 && pos_ < end_; shift += 7) {
+            uint8_t byte = *pos_++;
+            value |= uint64_t(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) return true;
+        }
+        return false;
+    }
+
+    bool read_tag(uint32_t& field, int& wire_type) {
+        uint64_t tag = 0;
+        if (!read_varint(tag)) return false;
+        field = static_cast<uint32_t>(tag >> 3);
+        wire_type = static_cast<int>(tag & 0x7);
+        return field != 0;
+    }
+
+    bool read_bytes(const uint8_t*& data, size_t& size) {
+        uint64_t length = 0;
+        if (!read_varint(length) || length > size_t(end_ - pos_)) return false;
+        data = pos_;
+        size = static_cast<size_t>(length);
+        pos_ += length;
+        return true;
+    }
+
+    bool read_fixed(void* out, size_t size) {
+        if (size > size_t(end_ - pos_)) return false;
+        std::memcpy(out, pos_, size);
+        pos_ += size;
+        return true;
+    }
+
+    bool skip(int wire_type) {
+        uint64_t ignored = 0;
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+        switch (wire_type) {
+            case kWireVarint: return read_varint(ignored);
+            case kWireFixed64: return skip_bytes(8);
+            case kWireLengthDelimited: return read_bytes(data, size);
+            case kWireFixed32: return skip_bytes(4);
+            default: return false;
+        }
+    }
+
+private:
+    bool skip_bytes(size_t size) {
+        if (size > size_t(end_ - pos_)) return false;
+        pos_ += size;
+        return true;
+    }
+
+    const uint8_t* pos_;
+    const uint8_t* end_;
+};
+
+size_t element_size(int32_t data_type) {
+    switch (data_type) {
+        case 1: case 6: case 12: return 4;      // FLOAT, INT32, UINT32
+        case 2: case 3: case 9: return 1;       // UINT8, INT8, BOOL
+        case 4: case 5: case 10: case 16: return 2;  // UINT16, INT16, FLOAT16, BFLOAT16
+        case 7: case 11: case 13: return 8;     // INT64, DOUBLE, UINT64
+        default: return 0;
+    }
+}
+
+// 读取 repeated 标量字段（packed 或逐个编码），追加为 element_size 字节的小端值
+bool read_repeated(ProtoReader& reader, int wire_type, size_t width, bool fixed, std::vector<uint8_t>& out) {
+    auto append = [&](ProtoReader& r) {
+        uint64_t value = 0;
+        if (fixed) {
+            if (!r.read_fixed(&value, width)) return false;
+        } else if (!r.read_varint(value)) {
+            return false;
+        }
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+        out.insert(out.end(), bytes, bytes + width);
+        return true;
+    };
+
+    if (wire_type != kWireLengthDelimited) {
+        return append(reader);
+    }
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    if (!reader.read_bytes(data, size)) return false;
+    ProtoReader packed(data, size);
+    while (!packed.done()) {
+        if (!append(packed)) return false;
+    }
+    return true;
+}
+
+// 类型化字段按存储宽度读出后截断/保持为元素宽度（int32_data 中的 FLOAT16 等只取低位）
+std::vector<uint8_t> narrow(const std::vector<uint8_t>& wide, size_t wide_size, size_t size) {
+    std::vector<uint8_t> out;
+    out.reserve(wide.size() / wide_size * size);
+    for (size_t i = 0; i + wide_size <= wide.size(); i += wide_size) {
+        out.insert(out.end(), wide.begin() + i, wide.begin() + i + size);
+    }
+    return out;
+}
+
+bool read_external_data(const std::string& model_dir, const std::string& location,
+                        uint64_t offset, uint64_t length, std::vector<uint8_t>& data) {
+    std::ifstream file(model_dir + location, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "错误: 无法打开外部数据文件 " << model_dir + location << std::endl;
+        return false;
+    }
+    data.resize(length);
+    file.seekg(static_cast<std::streamoff>(offset));
+    file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(length));
+    return file.gcount() == static_cast<std::streamsize>(length);
+}
+
+bool parse_tensor(const uint8_t* message, size_t message_size, const std::string& model_dir,
+                  OnnxInitializer& tensor) {
+    ProtoReader reader(message, message_size);
+    std::vector<uint8_t> raw, int32_values, int64_values, float_values, double_values, uint64_values;
+    bool has_raw = false;
+    int64_t data_location = 0;
+    std::string location;
+    uint64_t external_offset = 0;
+    uint64_t external_length = 0;
+
+    while (!reader.done()) {
+        uint32_t field = 0;
+        int wire_type = 0;
+        if (!reader.read_tag(field, wire_type)) return false;
+
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+        uint64_t value = 0;
+        bool ok = true;
+        switch (field) {
+            case 1: {   // dims
+                std::vector<uint8_t> dims;
+                ok = read_repeated(reader, wire_type, 8, false, dims);
+                for (size_t i = 0; ok && i < dims.size(); i += 8) {
+                    int64_t dim = 0;
+                    std::memcpy(&dim, dims.data() + i, 8);
+                    tensor.dims.push_back(dim);
+                }
+                break;
+            }
+            case 2: ok = reader.read_varint(value); tensor.data_type = static_cast<int32_t>(value); break;
+            case 4: ok = read_repeated(reader, wire_type, 4, true, float_values); break;
+            case 5: ok = read_repeated(reader, wire_type, 8, false, int32_values); break;
+            case 7: ok = read_repeated(reader, wire_type, 8, false, int64_values); break;
+            case 8: ok = reader.read_bytes(data, size); tensor.name.assign(reinterpret_cast<const char*>(data), size); break;
+            case 9: ok = reader.read_bytes(data, size); raw.assign(data, data + size); has_raw = true; break;
+            case 10: ok = read_repeated(reader, wire_type, 8, true, double_values); break;
+            case 11: ok = read_repeated(reader, wire_type, 8, false, uint64_values); break;
+            case 13: {  // external_data: StringStringEntryProto { key = 1, value = 2 }
+                ok = reader.read_bytes(data, size);
+                ProtoReader entry(data, size);
+                std::string key, entry_value;
+                while (ok && !entry.done()) {
+                    uint32_t entry_field = 0;
+                    int entry_wire = 0;
+                    const uint8_t* text = nullptr;
+                    size_t text_size = 0;
+                    ok = entry.read_tag(entry_field, entry_wire);
+                    if (ok && (entry_field == 1 || entry_field == 2) && entry_wire == kWireLengthDelimited) {
+                        ok = entry.read_bytes(text, text_size);
+                        (entry_field == 1 ? key : entry_value).assign(reinterpret_cast<const char*>(text), text_size);
+                    } else if (ok) {
+                        ok = entry.skip(entry_wire);
+                    }
+                }
+                if (key == "location") location = entry_value;
+                else if (key == "offset") external_offset = std::stoull(entry_value);
+                else if (key == "length") external_length = std::stoull(entry_value);
+                break;
+            }
+            case 14: ok = reader.read_varint(value); data_location = static_cast<int64_t>(value); break;
+            default: ok = reader.skip(wire_type); break;
+        }
+        if (!ok) return false;
+    }
+
+    size_t width = element_size(tensor.data_type);
+    if (width == 0) {
+        return false;
+    }
+
+    uint64_t count = 1;
+    for (int64_t dim : tensor.dims) {
+        if (dim < 0) return false;
+        count *= static_cast<uint64_t>(dim);
+    }
+    uint64_t expected = count * width;
+
+    if (data_location == kLocationExternal) {
+        if (location.empty()) return false;
+        if (!read_external_data(model_dir, location, external_offset,
+                                external_length > 0 ? external_length : expected, tensor.data)) {
+            return false;
+        }
+    } else if (has_raw) {
+        tensor.data = std::move(raw);
+    } else if (tensor.data_type == kTypeFloat) {
+        tensor.data = std::move(float_values);
+    } else if (tensor.data_type == kTypeDouble) {
+        tensor.data = std::move(double_values);
+    } else if (tensor.data_type == kTypeInt64) {
+        tensor.data = std::move(int64_values);
+    } else if (tensor.data_type == kTypeUint32 || tensor.data_type == kTypeUint64) {
+        tensor.data = narrow(uint64_values, 8, width);
+    } else {
+        tensor.data = narrow(int32_values, 8, width);
+    }
+
+    return tensor.data.size() == expected;
+}
+
+} // namespace
+
+bool load_onnx_initializers(const std::string& model_path, std::vector<OnnxInitializer>& initializers) {
+    std::ifstream file(model_path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "错误: 无法打开模型文件 " << model_path << std::endl;
+        return false;
+    }
+    std::vector<uint8_t> model((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    size_t slash = model_path.find_last_of("/\\");
+    std::string model_dir = slash == std::string::npos ? "" : model_path.substr(0, slash + 1);
+
+    // ModelProto.graph = 7
+    const uint8_t* graph = nullptr;
+    size_t graph_size = 0;
+    ProtoReader reader(model.data(), model.size());
+    while (!reader.done()) {
+        uint32_t field = 0;
+        int wire_type = 0;
+        if (!reader.read_tag(field, wire_type)) return false;
+        if (field == 7 && wire_type == kWireLengthDelimited) {
+            if (!reader.read_bytes(graph, graph_size)) return false;
+        } else if (!reader.skip(wire_type)) {
+            return false;
+        }
+    }
+    if (graph == nullptr) {
+        std::cerr << "错误: 模型文件中没有计算图 " << model_path << std::endl;
+        return false;
+    }
+
+    // GraphProto.initializer = 5, GraphProto.input = 11 (ValueInfoProto.name = 1)
+    std::vector<std::pair<const uint8_t*, size_t>> tensor_messages;
+    std::set<std::string> input_names;
+    ProtoReader graph_reader(graph, graph_size);
+    while (!graph_reader.done()) {
+        uint32_t field = 0;
+        int wire_type = 0;
+        if (!graph_reader.read_tag(field, wire_type)) return false;
+
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+        if ((field == 5 || field == 11) && wire_type == kWireLengthDelimited) {
+            if (!graph_reader.read_bytes(data, size)) return false;
+            if (field == 5) {
+                tensor_messages.emplace_back(data, size);
+                continue;
+            }
+            ProtoReader value_info(data, size);
+            while (!value_info.done()) {
+                uint32_t info_field = 0;
+                int info_wire = 0;
+                if (!value_info.read_tag(info_field, info_wire)) return false;
+                const uint8_t* name = nullptr;
+                size_t name_size = 0;
+                if (info_field == 1 && info_wire == kWireLengthDelimited) {
+                    if (!value_info.read_bytes(name, name_size)) return false;
+                    input_names.emplace(reinterpret_cast<const char*>(name), name_size);
+                } else if (!value_info.skip(info_wire)) {
+                    return false;
+                }
+            }
+        } else if (!graph_reader.skip(wire_type)) {
+            return false;
+        }
+    }
+
+    initializers.clear();
+    initializers.reserve(tensor_messages.size());
+    for (const auto& message : tensor_messages) {
+        OnnxInitializer tensor;
+        bool ok = false;
+        try {
+            ok = parse_tensor(message.first, message.second, model_dir, tensor);
+        } catch (const std::exception&) {
+            ok = false;   // 外部数据的 offset/length 不是数字
+        }
+        if (!ok) {
+            if (tensor.data_type == kTypeString) continue;   // 字符串张量不共享
+            std::cerr << "错误: 无法解析 initializer " << tensor.name << std::endl;
+            return false;
+        }
+        if (input_names.count(tensor.name) > 0) {
+            continue;
+        }
+        initializers.push_back(std::move(tensor));
+    }
+    return true;
+}
@@ -0,0 +1,20 @@
+#ifndef ONNX_INITIALIZERS_H
+#define ONNX_INITIALIZERS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ONNX 模型中的一个常量权重（initializer），数据已展开为连续的小端字节
+struct OnnxInitializer {
+    std::string name;
+    int32_t data_type = 0;          // TensorProto.DataType，与 ONNXTensorElementDataType 取值一致
+    std::vector<int64_t> dims;
+    std::vector<uint8_t> data;
+};
+
+// 解析 ONNX 模型文件（protobuf 线格式）中的全部 initializer，支持 raw_data、类型化字段和外部数据文件
+// 同时作为图输入的 initializer（可被输入覆盖）和字符串张量会被跳过；解析失败返回 false
+bool load_onnx_initializers(const std::string& model_path, std::vector<OnnxInitializer>& initializers);
+
+#endif // ONNX_INITIALIZERS_H
@@ -0,0 +1,170 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <numeric>
+#include <algorithm>
+#include <opencv2/opencv.hpp>
+#include <fmt/format.h>
+#include <fmt/color.h>
+#include "detector_factory.h"
+#include "thread_placement.h"
+
+// 单轮测试结果
+struct PlacementResult {
+    double throughput_fps = 0.0;
+    double latency_p50_ms = 0.0;
+    double latency_p99_ms = 0.0;
+    double latency_max_ms = 0.0;
+    int frames = 0;
+};
+
+// 每个检测器一个工作线程，同时运行 frames 帧检测
+PlacementResult run_pass(const std::string& model_path, const cv::Mat& image,
+                         const std::vector<ThreadPlacement>& placements, int frames) {
+    PlacementResult result;
+
+    // 绑定的检测器使用会话独立的 Arena，对照组也关闭共享分配器，两组只有线程放置不同
+    DetectorFactory factory(true, false);
+    std::vector<std::unique_ptr<YOLOv5Detector>> detectors;
+    for (const auto& placement : placements) {
+        detectors.push_back(factory.create(model_path, 0.5f, 0.4f, placement));
+        if (!detectors.back()->is_model_loaded()) {
+            return result;
+        }
+        // 预热
+        detectors.back()->detect(image);
+    }
+
+    std::vector<std::vector<double>> latencies(detectors.size());
+    std::vector<std::thread> workers;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t d = 0; d < detectors.size(); ++d) {
+        workers.emplace_back([&, d]() {
+            // 绑定工作线程，图像拷贝等准备工作也在本节点完成
+            const ThreadPlacement& placement = detectors[d]->get_thread_placement();
+            if (placement.is_pinned()) {
+                pin_current_thread(placement.pipeline_cpus);
+                prefer_numa_node(placement.numa_node);
+            }
+            cv::Mat local_image = image.clone();
+
+            latencies[d].reserve(frames);
+            for (int i = 0; i < frames; ++i) {
+                auto frame_start = std::chrono::high_resolution_clock::now();
+                detectors[d]->detect(local_image);
+                auto frame_end = std::chrono::high_resolution_clock::now();
+                latencies[d].push_back(
+                    std::chrono::duration_cast<std::chrono::microseconds>(frame_end - frame_start).count() / 1000.0);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    std::vector<double> all;
+    for (const auto& per_detector : latencies) {
+        all.insert(all.end(), per_detector.begin(), per_detector.end());
+    }
+    if (all.empty()) {
+        return result;
+    }
+    std::sort(all.begin(), all.end());
+
+    double wall_seconds = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1e6;
+    result.frames = static_cast<int>(all.size());
+    result.throughput_fps = all.size() / wall_seconds;
+    result.latency_p50_ms = all[all.size() / 2];
+    result.latency_p99_ms = all[std::min(all.size() - 1, static_cast<size_t>(all.size() * 0.99))];
+    result.latency_max_ms = all.back();
+    return result;
+}
+
+int main(int argc, char** argv) {
+    fmt::print(fmt::fg(fmt::color::cyan) | fmt::emphasis::bold,
+               "🧵 YOLOv5 线程放置测试（NUMA 绑定 vs 未绑定）\n\n");
+
+    // 用法: placement_benchmark [模型路径] [图片路径] [布局配置] [每个检测器帧数]
+    std::string model_path = "/workspaces/YOLOv5-ONNXRuntime/assets/models/yolov5n.onnx";
+    std::string image_path = "/workspaces/YOLOv5-ONNXRuntime/assets/images/bus.jpg";
+    std::string layout_path;
+    int frames = 200;
+    if (argc > 1) model_path = argv[1];
+    if (argc > 2) image_path = argv[2];
+    if (argc > 3) layout_path = argv[3];
+    if (argc > 4) frames = std::max(1, std::atoi(argv[4]));
+
+    cv::Mat image = cv::imread(image_path);
+    if (image.empty()) {
+        fmt::print(fmt::fg(fmt::color::red), "❌ 错误: 无法加载图像 {}\n", image_path);
+        return -1;
+    }
+
+    CpuTopology topology = CpuTopology::discover();
+    fmt::print("🖥️  CPU 拓扑: {}\n", topology.describe());
+
+    // 布局：配置文件指定，或默认每个 NUMA 节点一个检测器
+    std::vector<DetectorLayout> layouts;
+    if (!layout_path.empty()) {
+        if (!load_layout_config(layout_path, layouts)) {
+            return -1;
+        }
+    } else {
+        for (const auto& node : topology.get_nodes()) {
+            DetectorLayout layout;
+            layout.numa_node = node.id;
+            layout.intra_op_threads = std::min<int>(4, static_cast<int>(node.cpus.size()));
+            layouts.push_back(layout);
+        }
+    }
+    if (layouts.empty()) {
+        fmt::print(fmt::fg(fmt::color::red), "❌ 错误: 布局为空\n");
+        return -1;
+    }
+
+    // 绑定方案；对照组线程数相同但不绑定
+    std::vector<ThreadPlacement> pinned = topology.plan(layouts);
+    std::vector<ThreadPlacement> unpinned;
+    for (const auto& layout : layouts) {
+        ThreadPlacement placement;
+        placement.intra_op_threads = layout.intra_op_threads;
+        unpinned.push_back(placement);
+    }
+
+    fmt::print("\n📌 检测器布局:\n");
+    for (size_t i = 0; i < pinned.size(); ++i) {
+        fmt::print("  • 检测器 {}: {}\n", i, pinned[i].describe());
+    }
+
+    fmt::print("\n🚀 每个检测器运行 {} 帧...\n", frames);
+    PlacementResult unpinned_result = run_pass(model_path, image, unpinned, frames);
+    PlacementResult pinned_result = run_pass(model_path, image, pinned, frames);
+
+    if (unpinned_result.frames == 0 || pinned_result.frames == 0) {
+        fmt::print(fmt::fg(fmt::color::red), "❌ 测试失败\n");
+        return -1;
+    }
+
+    fmt::print("\n");
+    fmt::print(fmt::fg(fmt::color::green) | fmt::emphasis::bold, "📊 线程放置对比结果\n");
+    fmt::print("┌──────────┬──────────┬──────────┬──────────┬──────────┐\n");
+    fmt::print("│ 模式     │ FPS      │ P50 (ms) │ P99 (ms) │ 最大(ms) │\n");
+    fmt::print("├──────────┼──────────┼──────────┼──────────┼──────────┤\n");
+    for (const auto& row : {std::make_pair("未绑定", unpinned_result), std::make_pair("NUMA绑定", pinned_result)}) {
+        fmt::print("│ {:<8} │ {:8.1f} │ {:8.2f} │ {:8.2f} │ {:8.2f} │\n",
+                   row.first, row.second.throughput_fps, row.second.latency_p50_ms,
+                   row.second.latency_p99_ms, row.second.latency_max_ms);
+    }
+    fmt::print("└──────────┴──────────┴──────────┴──────────┴──────────┘\n");
+
+    fmt::print("  • 吞吐量变化: {:+.1f}%\n",
+               (pinned_result.throughput_fps / unpinned_result.throughput_fps - 1.0) * 100);
+    fmt::print("  • P99 延迟变化: {:+.1f}%\n",
+               (pinned_result.latency_p99_ms / unpinned_result.latency_p99_ms - 1.0) * 100);
+
+    return 0;
+}
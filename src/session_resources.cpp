@@ -0,0 +1,95 @@
+#include "session_resources.h"
+#include <algorithm>
+#include <iostream>
+
+SessionResources::SessionResources(bool share_allocator) : share_allocator_(share_allocator) {
+    env_ = std::make_unique<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "YOLOv5");
+    prepacked_weights_ = std::make_unique<Ort::PrepackedWeightsContainer>();
+
+    if (share_allocator_) {
+        try {
+            // 注册共享的 CPU Arena 分配器（参数 0/-1 表示使用 ORT 默认配置）
+            auto memory_info = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+            Ort::ArenaCfg arena_cfg(0, -1, -1, -1);
+            env_->CreateAndRegisterAllocator(memory_info, arena_cfg);
+        } catch (const Ort::Exception& e) {
+            std::cerr << "注册共享分配器失败，回退到会话独立分配器: " << e.what() << std::endl;
+            share_allocator_ = false;
+        }
+    }
+}
+
+SessionResources::~SessionResources() {
+    // 智能指针会自动清理资源（使用这些资源的会话必须先销毁）
+}
+
+Ort::Env& SessionResources::get_env() {
+    return *env_;
+}
+
+Ort::PrepackedWeightsContainer& SessionResources::get_prepacked_weights() {
+    return *prepacked_weights_;
+}
+
+bool SessionResources::is_allocator_shared() const {
+    return share_allocator_;
+}
+
+void SessionResources::configure_session_options(Ort::SessionOptions& options, const std::string& model_path) {
+    if (share_allocator_) {
+        options.AddConfigEntry("session.use_env_allocators", "1");
+    }
+
+    std::shared_ptr<SharedInitializers> shared = get_initializers(model_path);
+    if (!shared) {
+        return;
+    }
+    for (size_t i = 0; i < shared->values.size(); ++i) {
+        options.AddInitializer(shared->tensors[i].name.c_str(), shared->values[i]);
+    }
+}
+
+size_t SessionResources::get_shared_initializer_count(const std::string& model_path) {
+    std::lock_guard<std::mutex> lock(initializers_mutex_);
+    auto it = initializers_.find(model_path);
+    return it != initializers_.end() && it->second ? it->second->values.size() : 0;
+}
+
+std::shared_ptr<SessionResources::SharedInitializers> SessionResources::get_initializers(const std::string& model_path) {
+    std::lock_guard<std::mutex> lock(initializers_mutex_);
+    auto it = initializers_.find(model_path);
+    if (it != initializers_.end()) {
+        return it->second;
+    }
+
+    // 加载失败也记录下来，后续会话直接回退到各自加载权重
+    auto shared = std::make_shared<SharedInitializers>();
+    if (!load_onnx_initializers(model_path, shared->tensors)) {
+        std::cerr << "警告: 无法读取 " << model_path << " 的权重，会话将各自加载权重" << std::endl;
+        initializers_[model_path] = nullptr;
+        return nullptr;
+    }
+
+    try {
+        // 空张量无需共享
+        auto& tensors = shared->tensors;
+        tensors.erase(std::remove_if(tensors.begin(), tensors.end(),
+                                     [](const OnnxInitializer& tensor) { return tensor.data.empty(); }),
+                      tensors.end());
+
+        // Ort::Value 直接引用 tensors 中的缓冲区，不复制数据
+        auto memory_info = Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
+        for (auto& tensor : tensors) {
+            shared->values.push_back(Ort::Value::CreateTensor(
+                memory_info, tensor.data.data(), tensor.data.size(), tensor.dims.data(), tensor.dims.size(),
+                static_cast<ONNXTensorElementDataType>(tensor.data_type)));
+        }
+    } catch (const Ort::Exception& e) {
+        std::cerr << "警告: 创建共享权重张量失败，会话将各自加载权重: " << e.what() << std::endl;
+        initializers_[model_path] = nullptr;
+        return nullptr;
+    }
+
+    initializers_[model_path] = shared;
+    return shared;
+}
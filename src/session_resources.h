@@ -0,0 +1,54 @@
+#ifndef SESSION_RESOURCES_H
+#define SESSION_RESOURCES_H
+
+#include "onnx_initializers.h"
+#include <onnxruntime_cxx_api.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 多个检测器会话共享的 ONNX Runtime 资源
+// - 共享 Ort::Env（日志、全局状态只初始化一次）
+// - 共享 initializer：同一模型的权重只加载一份，通过 AddInitializer 注入每个会话
+// - 共享 PrepackedWeightsContainer：ORT 只为共享的 initializer 缓存预打包缓冲区，因此与上一项配合使用
+// - 可选：在 Env 中注册共享的 CPU Arena 分配器，所有会话复用同一块内存池
+class SessionResources {
+public:
+    explicit SessionResources(bool share_allocator = true);
+    ~SessionResources();
+
+    // 禁用拷贝构造和赋值
+    SessionResources(const SessionResources&) = delete;
+    SessionResources& operator=(const SessionResources&) = delete;
+
+    Ort::Env& get_env();
+    Ort::PrepackedWeightsContainer& get_prepacked_weights();
+    bool is_allocator_shared() const;
+
+    // 将共享相关的配置和该模型的共享 initializer 写入会话选项（创建会话前调用）
+    // 注意：ORT_ENABLE_ALL 的布局优化会改写卷积权重，共享的 initializer 不再被使用，需使用 ORT_ENABLE_EXTENDED 及以下级别
+    void configure_session_options(Ort::SessionOptions& options, const std::string& model_path);
+
+    // 已加载的共享 initializer 数量（未加载或加载失败时为 0）
+    size_t get_shared_initializer_count(const std::string& model_path);
+
+private:
+    // 每个模型路径一份：数据缓冲区和指向它的 Ort::Value，生命周期需覆盖使用它们的所有会话
+    struct SharedInitializers {
+        std::vector<OnnxInitializer> tensors;
+        std::vector<Ort::Value> values;
+    };
+
+    std::shared_ptr<SharedInitializers> get_initializers(const std::string& model_path);
+
+    std::unique_ptr<Ort::Env> env_;
+    std::unique_ptr<Ort::PrepackedWeightsContainer> prepacked_weights_;
+    bool share_allocator_;
+
+    std::mutex initializers_mutex_;
+    std::map<std::string, std::shared_ptr<SharedInitializers>> initializers_;
+};
+
+#endif // SESSION_RESOURCES_H
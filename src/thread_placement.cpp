@@ -0,0 +1,339 @@
+#include "thread_placement.h"
+#include <algorithm>
+#include <dirent.h>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <pthread.h>
+#include <sstream>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+// set_mempolicy 模式（见 linux/mempolicy.h），直接使用系统调用避免依赖 libnuma
+constexpr int kMpolDefault = 0;
+constexpr int kMpolPreferred = 1;
+constexpr int kMpolModeFlags = (1 << 15) | (1 << 14) | (1 << 13);   // MPOL_F_STATIC_NODES 等模式标志
+constexpr int kMaxNumaNodes = 1024;
+constexpr int kBitsPerWord = sizeof(unsigned long) * 8;
+constexpr int kMaskWords = kMaxNumaNodes / kBitsPerWord;
+
+cpu_set_t make_cpu_set(const std::vector<int>& cpus) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+    }
+    return set;
+}
+
+// 读取当前线程的内存策略；get_mempolicy 的 maxnode 不像 set_mempolicy 那样需要加 1
+bool get_thread_mempolicy(int& mode, std::vector<unsigned long>& mask) {
+    mask.assign(kMaskWords, 0);
+    return syscall(SYS_get_mempolicy, &mode, mask.data(), kMaxNumaNodes, nullptr, 0) == 0;
+}
+
+bool set_thread_mempolicy(int mode, const std::vector<unsigned long>& mask) {
+    if ((mode & ~kMpolModeFlags) == kMpolDefault) {
+        return syscall(SYS_set_mempolicy, kMpolDefault, nullptr, 0) == 0;
+    }
+    return syscall(SYS_set_mempolicy, mode, mask.data(), kMaxNumaNodes + 1) == 0;
+}
+
+bool is_preferred_node(int mode, const std::vector<unsigned long>& mask, int node) {
+    if ((mode & ~kMpolModeFlags) != kMpolPreferred || node < 0 || node >= kMaxNumaNodes) {
+        return false;
+    }
+    for (int word = 0; word < kMaskWords; ++word) {
+        unsigned long expected = word == node / kBitsPerWord ? 1UL << (node % kBitsPerWord) : 0;
+        if (mask[word] != expected) return false;
+    }
+    return true;
+}
+
+std::string read_first_line(const std::string& path) {
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line);
+    return line;
+}
+
+int read_int(const std::string& path, int fallback) {
+    std::string line = read_first_line(path);
+    try {
+        return line.empty() ? fallback : std::stoi(line);
+    } catch (const std::exception&) {
+        return fallback;
+    }
+}
+
+std::string join_cpus(const std::vector<int>& cpus, const char* separator, int offset) {
+    std::string text;
+    for (size_t i = 0; i < cpus.size(); ++i) {
+        if (i > 0) text += separator;
+        text += std::to_string(cpus[i] + offset);
+    }
+    return text;
+}
+
+} // namespace
+
+bool ThreadPlacement::is_pinned() const {
+    return numa_node >= 0 && !pipeline_cpus.empty();
+}
+
+std::string ThreadPlacement::ort_affinity_string() const {
+    // ORT 需要为线程 1..N-1 各提供一项，用 ';' 分隔，逻辑处理器编号从 1 开始
+    return join_cpus(ort_thread_cpus, ";", 1);
+}
+
+std::string ThreadPlacement::describe() const {
+    if (!is_pinned()) {
+        return "未绑定, " + std::to_string(intra_op_threads) + " 线程";
+    }
+    return "节点 " + std::to_string(numa_node) + ", " + std::to_string(intra_op_threads) +
+           " 线程, 调用线程 CPU [" + join_cpus(pipeline_cpus, ",", 0) +
+           "], ORT 线程 CPU [" + join_cpus(ort_thread_cpus, ",", 0) + "]";
+}
+
+CpuTopology CpuTopology::discover() {
+    CpuTopology topology;
+    const std::string node_root = "/sys/devices/system/node";
+
+    // 读取各 NUMA 节点的 CPU 列表
+    std::map<int, std::vector<int>> node_cpus;
+    if (DIR* dir = opendir(node_root.c_str())) {
+        while (dirent* entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            if (name.rfind("node", 0) != 0 || name.size() <= 4 ||
+                !std::all_of(name.begin() + 4, name.end(), ::isdigit)) {
+                continue;
+            }
+            int node = std::stoi(name.substr(4));
+            std::vector<int> cpus = parse_cpu_list(read_first_line(node_root + "/" + name + "/cpulist"));
+            if (!cpus.empty()) {
+                node_cpus[node] = cpus;
+            }
+        }
+        closedir(dir);
+    }
+
+    // 没有 NUMA 信息（容器、单插槽或非 NUMA 内核）时视为单节点
+    if (node_cpus.empty()) {
+        std::vector<int> cpus = parse_cpu_list(read_first_line("/sys/devices/system/cpu/online"));
+        if (cpus.empty()) {
+            unsigned int count = std::max(1u, std::thread::hardware_concurrency());
+            for (unsigned int i = 0; i < count; ++i) cpus.push_back(static_cast<int>(i));
+        }
+        node_cpus[0] = cpus;
+    }
+
+    for (const auto& kv : node_cpus) {
+        for (int cpu : kv.second) {
+            std::string topo = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/";
+            CpuInfo info;
+            info.cpu_id = cpu;
+            info.core_id = read_int(topo + "core_id", cpu);
+            info.package_id = read_int(topo + "physical_package_id", 0);
+            info.numa_node = kv.first;
+            topology.cpus_.push_back(info);
+        }
+    }
+
+    // 同一物理核心编号最小的逻辑 CPU 视为主线程，其余为超线程兄弟
+    std::map<std::pair<int, int>, int> primary_of_core;
+    for (const auto& info : topology.cpus_) {
+        auto key = std::make_pair(info.package_id, info.core_id);
+        auto it = primary_of_core.find(key);
+        if (it == primary_of_core.end() || info.cpu_id < it->second) {
+            primary_of_core[key] = info.cpu_id;
+        }
+    }
+
+    for (const auto& kv : node_cpus) {
+        NumaNode node;
+        node.id = kv.first;
+        std::vector<int> primaries, siblings;
+        for (const auto& info : topology.cpus_) {
+            if (info.numa_node != node.id) continue;
+            bool primary = primary_of_core[std::make_pair(info.package_id, info.core_id)] == info.cpu_id;
+            (primary ? primaries : siblings).push_back(info.cpu_id);
+        }
+        std::sort(primaries.begin(), primaries.end());
+        std::sort(siblings.begin(), siblings.end());
+        node.cpus = primaries;
+        node.cpus.insert(node.cpus.end(), siblings.begin(), siblings.end());
+        topology.nodes_.push_back(node);
+    }
+
+    return topology;
+}
+
+const std::vector<NumaNode>& CpuTopology::get_nodes() const {
+    return nodes_;
+}
+
+const std::vector<CpuInfo>& CpuTopology::get_cpus() const {
+    return cpus_;
+}
+
+int CpuTopology::get_node_of_cpu(int cpu_id) const {
+    for (const auto& info : cpus_) {
+        if (info.cpu_id == cpu_id) return info.numa_node;
+    }
+    return -1;
+}
+
+std::string CpuTopology::describe() const {
+    std::string text = std::to_string(nodes_.size()) + " 个 NUMA 节点, " +
+                       std::to_string(cpus_.size()) + " 个逻辑 CPU";
+    for (const auto& node : nodes_) {
+        text += "\n  节点 " + std::to_string(node.id) + ": [" + join_cpus(node.cpus, ",", 0) + "]";
+    }
+    return text;
+}
+
+std::vector<ThreadPlacement> CpuTopology::plan(const std::vector<DetectorLayout>& layouts) const {
+    std::vector<ThreadPlacement> placements;
+    std::map<int, size_t> next_cpu;   // 每个节点下一个可分配的位置
+
+    for (const auto& layout : layouts) {
+        ThreadPlacement placement;
+        placement.intra_op_threads = std::max(1, layout.intra_op_threads);
+
+        auto node_it = std::find_if(nodes_.begin(), nodes_.end(),
+                                    [&](const NumaNode& node) { return node.id == layout.numa_node; });
+        if (layout.numa_node < 0 || node_it == nodes_.end()) {
+            if (layout.numa_node >= 0) {
+                std::cerr << "警告: NUMA 节点 " << layout.numa_node << " 不存在，检测器不绑定线程" << std::endl;
+            }
+            placements.push_back(placement);
+            continue;
+        }
+
+        const std::vector<int>& cpus = node_it->cpus;
+        size_t& cursor = next_cpu[node_it->id];
+        if (cursor + placement.intra_op_threads > cpus.size()) {
+            std::cerr << "警告: 节点 " << node_it->id << " 的 CPU 不足，检测器线程将与其他检测器共享核心" << std::endl;
+        }
+
+        placement.numa_node = node_it->id;
+        placement.node_cpus = cpus;
+        for (int t = 0; t < placement.intra_op_threads; ++t) {
+            int cpu = cpus[cursor % cpus.size()];
+            cursor++;
+            if (t == 0) {
+                placement.pipeline_cpus.push_back(cpu);
+            } else {
+                placement.ort_thread_cpus.push_back(cpu);
+            }
+        }
+        placements.push_back(placement);
+    }
+
+    return placements;
+}
+
+std::vector<int> parse_cpu_list(const std::string& text) {
+    std::vector<int> cpus;
+    std::stringstream ss(text);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        if (range.empty()) continue;
+        try {
+            size_t dash = range.find('-');
+            if (dash == std::string::npos) {
+                cpus.push_back(std::stoi(range));
+            } else {
+                int first = std::stoi(range.substr(0, dash));
+                int last = std::stoi(range.substr(dash + 1));
+                for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+            }
+        } catch (const std::exception&) {
+            return {};
+        }
+    }
+    return cpus;
+}
+
+bool load_layout_config(const std::string& path, std::vector<DetectorLayout>& layouts) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "错误: 无法打开布局配置 " << path << std::endl;
+        return false;
+    }
+
+    layouts.clear();
+    std::string line;
+    int line_number = 0;
+    while (std::getline(file, line)) {
+        line_number++;
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) line = line.substr(0, comment);
+
+        std::istringstream iss(line);
+        DetectorLayout layout;
+        if (!(iss >> layout.numa_node)) continue;   // 空行
+        if (!(iss >> layout.intra_op_threads) || layout.intra_op_threads <= 0) {
+            std::cerr << "错误: 布局配置第 " << line_number << " 行格式错误，应为 <numa_node> <intra_op_threads>"
+                      << std::endl;
+            return false;
+        }
+        layouts.push_back(layout);
+    }
+    return true;
+}
+
+bool pin_current_thread(const std::vector<int>& cpus) {
+    if (cpus.empty()) {
+        return false;
+    }
+
+    cpu_set_t set = make_cpu_set(cpus);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+bool prefer_numa_node(int node) {
+    if (node < 0) {
+        return syscall(SYS_set_mempolicy, kMpolDefault, nullptr, 0) == 0;
+    }
+    if (node >= kMaxNumaNodes) {
+        return false;
+    }
+
+    unsigned long mask[kMaskWords] = {};
+    mask[node / kBitsPerWord] = 1UL << (node % kBitsPerWord);
+    return syscall(SYS_set_mempolicy, kMpolPreferred, mask, kMaxNumaNodes + 1) == 0;
+}
+
+ScopedThreadPlacement::ScopedThreadPlacement(const ThreadPlacement& placement) {
+    if (!placement.is_pinned()) {
+        return;
+    }
+
+    // 已绑定到相同 CPU 的线程（如 placement_benchmark 的工作线程）每帧只需一次查询，不再迁移
+    CPU_ZERO(&previous_affinity_);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(previous_affinity_), &previous_affinity_) == 0) {
+        cpu_set_t target = make_cpu_set(placement.pipeline_cpus);
+        if (!CPU_EQUAL(&target, &previous_affinity_)) {
+            affinity_changed_ = pin_current_thread(placement.pipeline_cpus);
+        }
+    }
+
+    // 保存原策略，离开时原样恢复，而不是重置为默认策略
+    if (get_thread_mempolicy(previous_policy_mode_, previous_policy_mask_) &&
+        !is_preferred_node(previous_policy_mode_, previous_policy_mask_, placement.numa_node)) {
+        policy_changed_ = prefer_numa_node(placement.numa_node);
+    }
+}
+
+ScopedThreadPlacement::~ScopedThreadPlacement() {
+    if (affinity_changed_) {
+        pthread_setaffinity_np(pthread_self(), sizeof(previous_affinity_), &previous_affinity_);
+    }
+    if (policy_changed_) {
+        set_thread_mempolicy(previous_policy_mode_, previous_policy_mask_);
+    }
+}
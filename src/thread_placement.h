@@ -0,0 +1,93 @@
+#ifndef THREAD_PLACEMENT_H
+#define THREAD_PLACEMENT_H
+
+#include <string>
+#include <vector>
+#include <sched.h>
+
+// 逻辑 CPU 信息（来自 sysfs）
+struct CpuInfo {
+    int cpu_id = 0;
+    int core_id = 0;        // 物理核心编号（同一核心的超线程共享 L1/L2）
+    int package_id = 0;     // CPU 插槽编号
+    int numa_node = 0;
+};
+
+// NUMA 节点，cpus 按"先物理核心、后超线程兄弟"排序
+struct NumaNode {
+    int id = 0;
+    std::vector<int> cpus;
+};
+
+// 单个检测器的布局配置
+struct DetectorLayout {
+    int numa_node = -1;         // -1 表示不绑定
+    int intra_op_threads = 4;   // ORT intra-op 线程数（含调用线程）
+};
+
+// 单个检测器的线程放置结果
+struct ThreadPlacement {
+    int numa_node = -1;                 // -1 表示不绑定（保持 ORT 默认行为）
+    int intra_op_threads = 4;           // ORT intra-op 线程数（含调用线程）
+    std::vector<int> pipeline_cpus;     // 调用线程（预处理、后处理、ORT 线程 0）可运行的 CPU
+    std::vector<int> ort_thread_cpus;   // ORT intra-op 线程 1..N-1 各自绑定的 CPU
+    std::vector<int> node_cpus;         // 所在节点的全部 CPU，供多线程流水线（如异步执行器）使用
+
+    bool is_pinned() const;
+    // 生成 ORT "session.intra_op_thread_affinities" 配置（逻辑处理器编号从 1 开始）
+    std::string ort_affinity_string() const;
+    std::string describe() const;
+};
+
+// CPU 拓扑 - 从 /sys/devices/system 读取 NUMA 节点和核心信息
+class CpuTopology {
+public:
+    static CpuTopology discover();
+
+    const std::vector<NumaNode>& get_nodes() const;
+    const std::vector<CpuInfo>& get_cpus() const;
+    int get_node_of_cpu(int cpu_id) const;
+    std::string describe() const;
+
+    // 为每个检测器分配 CPU：同一节点上的检测器依次占用连续的物理核心，
+    // 调用线程占第一个核心，其余核心分给 ORT 线程；物理核心用完后才使用超线程兄弟
+    std::vector<ThreadPlacement> plan(const std::vector<DetectorLayout>& layouts) const;
+
+private:
+    std::vector<NumaNode> nodes_;
+    std::vector<CpuInfo> cpus_;
+};
+
+// 解析 sysfs 风格的 CPU 列表，如 "0-3,8-11"
+std::vector<int> parse_cpu_list(const std::string& text);
+
+// 读取布局配置文件：每行 "<numa_node> <intra_op_threads>" 描述一个检测器，# 开头为注释
+bool load_layout_config(const std::string& path, std::vector<DetectorLayout>& layouts);
+
+// 将当前线程绑定到指定 CPU 集合
+bool pin_current_thread(const std::vector<int>& cpus);
+
+// 设置当前线程的内存策略为优先从指定 NUMA 节点分配（-1 恢复默认策略）
+bool prefer_numa_node(int node);
+
+// RAII：在作用域内将当前线程绑定到放置结果的 CPU 和 NUMA 节点，离开时恢复原来的亲和性和内存策略
+// 在该作用域内创建会话或分配张量缓冲区，内存页会优先落在本节点；
+// 线程已绑定到相同 CPU 或已优先该节点时不再重复设置（如工作线程自己已经绑定）
+class ScopedThreadPlacement {
+public:
+    explicit ScopedThreadPlacement(const ThreadPlacement& placement);
+    ~ScopedThreadPlacement();
+
+    // 禁用拷贝构造和赋值
+    ScopedThreadPlacement(const ScopedThreadPlacement&) = delete;
+    ScopedThreadPlacement& operator=(const ScopedThreadPlacement&) = delete;
+
+private:
+    cpu_set_t previous_affinity_;
+    int previous_policy_mode_ = 0;
+    std::vector<unsigned long> previous_policy_mask_;
+    bool affinity_changed_ = false;
+    bool policy_changed_ = false;
+};
+
+#endif // THREAD_PLACEMENT_H
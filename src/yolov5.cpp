@@ -3,6 +3,7 @@
 #include <cmath>
 #include <iostream>
 #include <iomanip>
+#include <utility>
 
 // COCO 数据集类别名称
 const std::vector<std::string> YOLOv5Detector::class_names_ = {
@@ -28,22 +29,51 @@ YOLOv5Detector::YOLOv5Detector(const std::string& model_path,
     load_model(model_path);
 }
 
+YOLOv5Detector::YOLOv5Detector(const std::string& model_path,
+                               std::shared_ptr<SessionResources> resources,
+                               float confidence_threshold,
+                               float nms_threshold,
+                               const ThreadPlacement& placement)
+    : resources_(std::move(resources)), placement_(placement) {
+    confidence_threshold_ = confidence_threshold;
+    nms_threshold_ = nms_threshold;
+    model_path_ = model_path;
+
+    // 加载模型
+    load_model(model_path);
+}
+
 YOLOv5Detector::~YOLOv5Detector() {
     // 智能指针会自动清理资源
 }
 
 bool YOLOv5Detector::load_model(const std::string& model_path) {
     try {
-        // 创建 ONNX Runtime 环境
-        env_ = std::make_unique<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "YOLOv5");
-
         // 创建会话选项
         session_options_ = std::make_unique<Ort::SessionOptions>();
-        session_options_->SetIntraOpNumThreads(4);
+        session_options_->SetIntraOpNumThreads(placement_.intra_op_threads);
         session_options_->SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_EXTENDED);
 
-        // 加载模型
-        session_ = std::make_unique<Ort::Session>(*env_, model_path.c_str(), *session_options_);
+        // 绑定 ORT intra-op 线程 1..N-1（线程 0 为调用线程，由 detect 绑定）
+        if (placement_.is_pinned() && !placement_.ort_thread_cpus.empty()) {
+            session_options_->AddConfigEntry("session.intra_op_thread_affinities",
+                                             placement_.ort_affinity_string().c_str());
+        }
+
+        // 在目标 NUMA 节点上创建会话，权重和预打包缓冲区优先分配在本节点
+        ScopedThreadPlacement scoped_placement(placement_);
+
+        // 加载模型（始终从文件路径加载，外部数据文件由 ORT 内存映射，多个会话通过页缓存共享）
+        if (resources_) {
+            // 共享模式：复用 Env、该模型的共享 initializer、预打包权重容器和 Env 注册的分配器
+            resources_->configure_session_options(*session_options_, model_path);
+            session_ = std::make_unique<Ort::Session>(resources_->get_env(), model_path.c_str(),
+                                                      *session_options_, resources_->get_prepacked_weights());
+        } else {
+            // 独立模式：创建 ONNX Runtime 环境
+            env_ = std::make_unique<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "YOLOv5");
+            session_ = std::make_unique<Ort::Session>(*env_, model_path.c_str(), *session_options_);
+        }
 
         // 设置输入输出节点名称
         input_node_names_ = {"images"};
@@ -54,6 +84,26 @@ bool YOLOv5Detector::load_model(const std::string& model_path) {
         auto input_tensor_info = input_type_info.GetTensorTypeAndShapeInfo();
         input_node_dims_ = input_tensor_info.GetShape();
 
+        // 输入输出类型：FP16 导出的模型为 float16，FP32 和 QDQ INT8 模型为 float32
+        input_type_ = input_tensor_info.GetElementType();
+        Ort::TypeInfo output_type_info = session_->GetOutputTypeInfo(0);
+        ONNXTensorElementDataType output_type = output_type_info.GetTensorTypeAndShapeInfo().GetElementType();
+        for (auto type : {input_type_, output_type}) {
+            if (type != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT && type != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16) {
+                std::cerr << "模型加载失败: 仅支持 float32/float16 输入输出，实际类型为 " << type << std::endl;
+                model_loaded_ = false;
+                return false;
+            }
+        }
+
+        // 动态尺寸导出的模型（维度为 -1），默认使用 1x3x640x640，可通过 set_input_size 调整
+        dynamic_input_ = input_node_dims_.size() == 4 && (input_node_dims_[2] <= 0 || input_node_dims_[3] <= 0);
+        if (input_node_dims_.size() == 4) {
+            if (input_node_dims_[0] <= 0) input_node_dims_[0] = 1;
+            if (input_node_dims_[2] <= 0) input_node_dims_[2] = 640;
+            if (input_node_dims_[3] <= 0) input_node_dims_[3] = 640;
+        }
+
         model_loaded_ = true;
         model_path_ = model_path;
 
@@ -79,66 +129,185 @@ cv::Mat YOLOv5Detector::preprocess(const cv::Mat& input_image) {
     return preprocess_image(input_image, input_width, input_height);
 }
 
+// RunAsync 的上下文 - 输入缓冲区和张量需在回调之前保持有效
+struct YOLOv5Detector::AsyncInferenceContext {
+    InputBuffer input_buffer;
+    Ort::Value input_tensor{nullptr};
+    Ort::Value output_tensor{nullptr};
+    AsyncInferenceCallback on_complete;
+};
+
 std::vector<float> YOLOv5Detector::inference(const cv::Mat& preprocessed_image) {
     if (!model_loaded_ || preprocessed_image.empty()) {
         std::cerr << "错误: 模型未加载或预处理图像为空" << std::endl;
         return {};
     }
 
+    // 准备输入张量 - 按模型输入类型转换为 float16 或 float32
+    InputBuffer input_buffer;
+    Ort::Value input_tensor = create_input_tensor(preprocessed_image, input_buffer);
+
+    // 运行推理
+    try {
+        auto output_tensors = session_->Run(Ort::RunOptions{nullptr},
+                                          input_node_names_.data(), &input_tensor, 1,
+                                          output_node_names_.data(), 1);
+
+        return read_output_tensor(output_tensors[0]);
+
+    } catch (const Ort::Exception& e) {
+        std::cerr << "推理失败: " << e.what() << std::endl;
+        return {};
+    }
+}
+
+bool YOLOv5Detector::inference_async(const cv::Mat& preprocessed_image, AsyncInferenceCallback on_complete) {
+    if (!model_loaded_ || preprocessed_image.empty()) {
+        std::cerr << "错误: 模型未加载或预处理图像为空" << std::endl;
+        return false;
+    }
+
+    // RunAsync 依赖 intra-op 线程池，单线程会话无法异步执行
+    if (placement_.intra_op_threads < 2) {
+        return false;
+    }
+
+    auto context = std::make_unique<AsyncInferenceContext>();
+    context->on_complete = std::move(on_complete);
+    context->input_tensor = create_input_tensor(preprocessed_image, context->input_buffer);
+
+    try {
+        session_->RunAsync(Ort::RunOptions{nullptr},
+                           input_node_names_.data(), &context->input_tensor, 1,
+                           output_node_names_.data(), &context->output_tensor, 1,
+                           &YOLOv5Detector::on_inference_complete, context.get());
+        // 回调负责释放上下文
+        context.release();
+        return true;
+
+    } catch (const Ort::Exception& e) {
+        std::cerr << "异步推理启动失败: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+void YOLOv5Detector::on_inference_complete(void* user_data, OrtValue** /*outputs*/, size_t /*num_outputs*/,
+                                           OrtStatusPtr status_ptr) {
+    std::unique_ptr<AsyncInferenceContext> context(static_cast<AsyncInferenceContext*>(user_data));
+    Ort::Status status(status_ptr);
+
+    if (!status.IsOK()) {
+        context->on_complete({}, status.GetErrorMessage());
+        return;
+    }
+
+    // 输出写入了 RunAsync 传入的 output_tensor
+    context->on_complete(read_output_tensor(context->output_tensor), "");
+}
+
+Ort::Value YOLOv5Detector::create_input_tensor(const cv::Mat& preprocessed_image, InputBuffer& buffer) {
     int input_width = static_cast<int>(input_node_dims_[3]);
     int input_height = static_cast<int>(input_node_dims_[2]);
+    size_t input_size = static_cast<size_t>(input_width) * input_height * 3;
 
-    // 准备输入张量 - 转换为 float16
-    std::vector<Ort::Float16_t> input_tensor_values;
-    input_tensor_values.reserve(input_width * input_height * 3);
+    buffer.shape = {1, 3, input_height, input_width};
+    auto memory_info = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
 
-    // 转换为 CHW 格式并同时转换为 float16
+    if (input_type_ == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT) {
+        // FP32 模型（含 QDQ 量化模型）：转换为 CHW 格式
+        buffer.float_values.clear();
+        buffer.float_values.reserve(input_size);
+        for (int c = 0; c < 3; ++c) {
+            for (int h = 0; h < input_height; ++h) {
+                for (int w = 0; w < input_width; ++w) {
+                    buffer.float_values.push_back(preprocessed_image.at<cv::Vec3f>(h, w)[c]);
+                }
+            }
+        }
+        return Ort::Value::CreateTensor<float>(
+            memory_info, buffer.float_values.data(), buffer.float_values.size(),
+            buffer.shape.data(), buffer.shape.size());
+    }
+
+    // FP16 模型：转换为 CHW 格式并同时转换为 float16
+    buffer.half_values.clear();
+    buffer.half_values.reserve(input_size);
     for (int c = 0; c < 3; ++c) {
         for (int h = 0; h < input_height; ++h) {
             for (int w = 0; w < input_width; ++w) {
                 float val = preprocessed_image.at<cv::Vec3f>(h, w)[c];
-                input_tensor_values.push_back(Ort::Float16_t(val));
+                buffer.half_values.push_back(Ort::Float16_t(val));
             }
         }
     }
+    return Ort::Value::CreateTensor<Ort::Float16_t>(
+        memory_info, buffer.half_values.data(), buffer.half_values.size(),
+        buffer.shape.data(), buffer.shape.size());
+}
 
-    // 创建 float16 输入张量
-    std::vector<int64_t> input_shape = {1, 3, input_height, input_width};
-    auto memory_info = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
-    Ort::Value input_tensor = Ort::Value::CreateTensor<Ort::Float16_t>(
-        memory_info, input_tensor_values.data(), input_tensor_values.size(),
-        input_shape.data(), input_shape.size());
-
-    // 运行推理
-    try {
-        auto output_tensors = session_->Run(Ort::RunOptions{nullptr},
-                                          input_node_names_.data(), &input_tensor, 1,
-                                          output_node_names_.data(), 1);
+std::vector<float> YOLOv5Detector::read_output_tensor(const Ort::Value& output_tensor) {
+    // 将输出转换为float向量
+    auto type_info = output_tensor.GetTensorTypeAndShapeInfo();
+    auto output_shape = type_info.GetShape();
 
-        // 将输出转换为float向量
-        auto output_shape = output_tensors[0].GetTensorTypeAndShapeInfo().GetShape();
-        Ort::Float16_t* output_data_fp16 = const_cast<Ort::Float16_t*>(output_tensors[0].GetTensorData<Ort::Float16_t>());
+    size_t output_size = 1;
+    for (auto dim : output_shape) {
+        output_size *= dim;
+    }
 
-        size_t output_size = 1;
-        for (auto dim : output_shape) {
-            output_size *= dim;
-        }
+    if (type_info.GetElementType() == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT) {
+        const float* output_data_fp32 = output_tensor.GetTensorData<float>();
+        return std::vector<float>(output_data_fp32, output_data_fp32 + output_size);
+    }
 
-        std::vector<float> output_data(output_size);
-        for (size_t i = 0; i < output_size; ++i) {
-            output_data[i] = static_cast<float>(output_data_fp16[i]);
-        }
+    const Ort::Float16_t* output_data_fp16 = output_tensor.GetTensorData<Ort::Float16_t>();
+    std::vector<float> output_data(output_size);
+    for (size_t i = 0; i < output_size; ++i) {
+        output_data[i] = static_cast<float>(output_data_fp16[i]);
+    }
 
-        return output_data;
+    return output_data;
+}
 
-    } catch (const Ort::Exception& e) {
-        std::cerr << "推理失败: " << e.what() << std::endl;
+std::vector<Detection> YOLOv5Detector::postprocess(const std::vector<float>& inference_output,
+                                                  const cv::Mat& original_image) {
+    if (inference_output.empty() || original_image.empty()) {
         return {};
     }
+
+    std::vector<Detection> detections = extract_candidates(inference_output, original_image,
+                                                           confidence_threshold_);
+
+    // 应用 NMS
+    return apply_nms(detections, nms_threshold_);
 }
 
-std::vector<Detection> YOLOv5Detector::postprocess(const std::vector<float>& inference_output,
-                                                  const cv::Mat& original_image) {
+bool YOLOv5Detector::detect_candidates(const cv::Mat& image, float score_floor,
+                                       std::vector<Detection>& candidates) {
+    if (image.empty() || !model_loaded_) {
+        std::cerr << "错误: 模型未加载或输入图像为空" << std::endl;
+        return false;
+    }
+
+    ScopedThreadPlacement scoped_placement(placement_);
+
+    cv::Mat preprocessed = preprocess(image);
+    if (preprocessed.empty()) {
+        return false;
+    }
+
+    std::vector<float> inference_output = inference(preprocessed);
+    if (inference_output.empty()) {
+        return false;
+    }
+
+    candidates = extract_candidates(inference_output, image, score_floor);
+    return true;
+}
+
+std::vector<Detection> YOLOv5Detector::extract_candidates(const std::vector<float>& inference_output,
+                                                         const cv::Mat& original_image,
+                                                         float score_floor) {
     if (inference_output.empty() || original_image.empty()) {
         return {};
     }
@@ -146,8 +315,8 @@ std::vector<Detection> YOLOv5Detector::postprocess(const std::vector<float>& inf
     int input_width = static_cast<int>(input_node_dims_[3]);
     int input_height = static_cast<int>(input_node_dims_[2]);
 
-    // YOLOv5 输出格式: [batch, 25200, 85] (85 = 4 + 1 + 80)
-    int num_detections = 25200;  // 典型的YOLOv5输出
+    // YOLOv5 输出格式: [batch, N, 85] (85 = 4 + 1 + 80)，640x640 输入时 N = 25200
+    int num_detections = static_cast<int>(inference_output.size() / 85);
     int num_classes = 80;        // COCO数据集类别数
 
     std::vector<Detection> detections;
@@ -163,7 +332,7 @@ std::vector<Detection> YOLOv5Detector::postprocess(const std::vector<float>& inf
         if (base_idx + 84 >= static_cast<int>(inference_output.size())) break;
 
         float objectness = inference_output[base_idx + 4];
-        if (objectness < confidence_threshold_) continue;
+        if (objectness < score_floor) continue;
 
         // 找到最大类别概率
         float max_class_prob = 0.0f;
@@ -176,7 +345,7 @@ std::vector<Detection> YOLOv5Detector::postprocess(const std::vector<float>& inf
         }
 
         float confidence = objectness * max_class_prob;
-        if (confidence < confidence_threshold_) continue;
+        if (confidence < score_floor) continue;
 
         // 转换边界框坐标（从模型输出坐标转换为原图坐标）
         float cx = inference_output[base_idx + 0];
@@ -203,7 +372,18 @@ std::vector<Detection> YOLOv5Detector::postprocess(const std::vector<float>& inf
         detections.push_back(det);
     }
 
-    // 应用 NMS
+    return detections;
+}
+
+std::vector<Detection> YOLOv5Detector::select_detections(const std::vector<Detection>& candidates) {
+    std::vector<Detection> detections;
+    detections.reserve(candidates.size());
+    for (const auto& det : candidates) {
+        if (det.confidence >= confidence_threshold_) {
+            detections.push_back(det);
+        }
+    }
+
     return apply_nms(detections, nms_threshold_);
 }
 
@@ -218,6 +398,9 @@ std::vector<Detection> YOLOv5Detector::detect(const cv::Mat& image) {
         return {};
     }
 
+    // 绑定调用线程到会话所在的 NUMA 节点，预处理、推理输入缓冲区和后处理都在本节点完成
+    ScopedThreadPlacement scoped_placement(placement_);
+
     // 执行完整的检测流程
     cv::Mat preprocessed = preprocess(image);
     if (preprocessed.empty()) {
@@ -256,8 +439,16 @@ cv::Mat YOLOv5Detector::preprocess_image(const cv::Mat& image, int input_width,
 }
 
 std::vector<Detection> YOLOv5Detector::apply_nms(std::vector<Detection>& detections, float nms_threshold) {
-    std::sort(detections.begin(), detections.end(),
-              [](const Detection& a, const Detection& b) { return a.confidence > b.confidence; });
+    auto by_confidence = [](const Detection& a, const Detection& b) { return a.confidence > b.confidence; };
+
+    // 限制参与 NMS 的候选框数量（NMS 为 O(n^2)），只保留置信度最高的 max_candidates_ 个
+    if (max_candidates_ > 0 && detections.size() > max_candidates_) {
+        std::partial_sort(detections.begin(), detections.begin() + max_candidates_, detections.end(),
+                          by_confidence);
+        detections.resize(max_candidates_);
+    } else {
+        std::sort(detections.begin(), detections.end(), by_confidence);
+    }
 
     std::vector<Detection> result;
     std::vector<bool> suppressed(detections.size(), false);
@@ -306,6 +497,38 @@ float YOLOv5Detector::get_nms_threshold() const {
     return nms_threshold_;
 }
 
+const ThreadPlacement& YOLOv5Detector::get_thread_placement() const {
+    return placement_;
+}
+
+void YOLOv5Detector::set_max_candidates(size_t max_candidates) {
+    max_candidates_ = max_candidates;
+}
+
+size_t YOLOv5Detector::get_max_candidates() const {
+    return max_candidates_;
+}
+
+bool YOLOv5Detector::set_input_size(int width, int height) {
+    if (!model_loaded_ || !dynamic_input_) {
+        std::cerr << "错误: 模型输入尺寸固定，无法修改" << std::endl;
+        return false;
+    }
+    // YOLOv5 的最大下采样倍数为 32
+    if (width <= 0 || height <= 0 || width % 32 != 0 || height % 32 != 0) {
+        std::cerr << "错误: 输入尺寸必须为 32 的正整数倍" << std::endl;
+        return false;
+    }
+
+    input_node_dims_[2] = height;
+    input_node_dims_[3] = width;
+    return true;
+}
+
+bool YOLOv5Detector::has_dynamic_input() const {
+    return dynamic_input_;
+}
+
 // 模型信息接口实现
 bool YOLOv5Detector::is_model_loaded() const {
     return model_loaded_;
@@ -325,6 +548,17 @@ std::string YOLOv5Detector::get_model_info() const {
     return info;
 }
 
+std::string YOLOv5Detector::get_model_path() const {
+    return model_path_;
+}
+
+cv::Size YOLOv5Detector::get_input_size() const {
+    if (!model_loaded_) {
+        return cv::Size();
+    }
+    return cv::Size(static_cast<int>(input_node_dims_[3]), static_cast<int>(input_node_dims_[2]));
+}
+
 std::vector<Detection> YOLOv5Detector::postprocess_internal(const Ort::Value& output_tensor,
                                                            const cv::Mat& original_image,
                                                            int input_width, int input_height) {
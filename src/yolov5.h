@@ -2,10 +2,13 @@
 #define YOLOV5_H
 
 #include "Algorithm.h"
+#include "session_resources.h"
+#include "thread_placement.h"
 #include <opencv2/opencv.hpp>
 #include <onnxruntime_cxx_api.h>
 #include <vector>
 #include <string>
+#include <functional>
 
 // YOLOv5 检测结果结构
 struct Detection {
@@ -27,6 +30,14 @@ public:
                    float confidence_threshold = 0.5f,
                    float nms_threshold = 0.4f);
 
+    // 使用共享资源的构造函数 - 多个检测器共享 Env、预打包权重和分配器
+    // resources 为空时使用独立会话；placement 描述 ORT 线程数和 CPU/NUMA 绑定
+    YOLOv5Detector(const std::string& model_path,
+                   std::shared_ptr<SessionResources> resources,
+                   float confidence_threshold = 0.5f,
+                   float nms_threshold = 0.4f,
+                   const ThreadPlacement& placement = ThreadPlacement());
+
     // 析构函数
     ~YOLOv5Detector() override;
 
@@ -50,6 +61,36 @@ public:
     std::string get_model_info() const override;
     std::string get_class_name(int class_id) const override;
 
+    // 异步推理 - 基于 ORT RunAsync，立即返回；完成后在 ORT 线程上调用 on_complete(输出, 错误信息)
+    // 需要 intra-op 线程数 >= 2，否则返回 false，调用方应改用同步 inference
+    using AsyncInferenceCallback = std::function<void(std::vector<float>, const std::string&)>;
+    bool inference_async(const cv::Mat& preprocessed_image, AsyncInferenceCallback on_complete);
+
+    // 候选框接口 - 将解析和 NMS 拆开，便于缓存 NMS 之前的候选框后重新设定阈值
+    // 解析推理输出，保留得分不低于 score_floor 的候选框（未做 NMS）
+    std::vector<Detection> extract_candidates(const std::vector<float>& inference_output,
+                                              const cv::Mat& original_image,
+                                              float score_floor);
+    // 按当前置信度阈值过滤候选框并执行 NMS
+    std::vector<Detection> select_detections(const std::vector<Detection>& candidates);
+    // 完整执行预处理和推理（与 detect 相同，应用线程放置），返回 NMS 之前的候选框；失败时返回 false
+    bool detect_candidates(const cv::Mat& image, float score_floor, std::vector<Detection>& candidates);
+
+    // 模型路径和输入尺寸（用于构造缓存键等）
+    std::string get_model_path() const;
+    cv::Size get_input_size() const;
+
+    // 动态尺寸模型可在加载后修改输入尺寸（宽高需为 32 的倍数），固定尺寸模型返回 false
+    bool set_input_size(int width, int height);
+    bool has_dynamic_input() const;
+
+    // 线程放置（NUMA 节点、ORT 线程亲和性）
+    const ThreadPlacement& get_thread_placement() const;
+
+    // NMS 之前保留的候选框上限（按置信度取 top-k），0 表示不限制
+    void set_max_candidates(size_t max_candidates);
+    size_t get_max_candidates() const;
+
     // 保持原有的绘制接口（向后兼容）
     cv::Mat draw_detections(const cv::Mat& image, const std::vector<Detection>& detections);
 
@@ -57,11 +98,23 @@ private:
     // 内部辅助函数
     cv::Mat preprocess_image(const cv::Mat& image, int input_width, int input_height);
     std::vector<Detection> apply_nms(std::vector<Detection>& detections, float nms_threshold);
+    // 推理输入缓冲区（按模型输入类型使用其中一个），需在张量使用期间保持有效
+    struct InputBuffer {
+        std::vector<Ort::Float16_t> half_values;
+        std::vector<float> float_values;
+        std::vector<int64_t> shape;
+    };
+    struct AsyncInferenceContext;
+    Ort::Value create_input_tensor(const cv::Mat& preprocessed_image, InputBuffer& buffer);
+    static std::vector<float> read_output_tensor(const Ort::Value& output_tensor);
+    static void on_inference_complete(void* user_data, OrtValue** outputs, size_t num_outputs,
+                                      OrtStatusPtr status);
     std::vector<Detection> postprocess_internal(const Ort::Value& output_tensor,
                                                const cv::Mat& original_image,
                                                int input_width, int input_height);
 
-    // ONNX Runtime 相关成员变量
+    // ONNX Runtime 相关成员变量（共享资源需在会话之后销毁）
+    std::shared_ptr<SessionResources> resources_;
     std::unique_ptr<Ort::Env> env_;
     std::unique_ptr<Ort::Session> session_;
     std::unique_ptr<Ort::SessionOptions> session_options_;
@@ -69,6 +122,10 @@ private:
     std::vector<const char*> input_node_names_;
     std::vector<const char*> output_node_names_;
     std::vector<int64_t> input_node_dims_;
+    ONNXTensorElementDataType input_type_ = ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16;
+    bool dynamic_input_ = false;
+    ThreadPlacement placement_;
+    size_t max_candidates_ = 0;
     
     // COCO 数据集类别名称
     static const std::vector<std::string> class_names_;